@@ -3,12 +3,23 @@
 //-----------------------------------------------------------------------------
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>  // для std::ifstream
 #include <vector>
 #include <stdexcept>
 
+#include "mapped_file.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+    #include <immintrin.h>
+#endif
+
 namespace utils
 {
     // Таблица для расчета CRC32 (полином 0xEDB88320)
@@ -58,36 +69,288 @@ namespace utils
             0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
     };
 
+    namespace detail
+    {
+        // Таблицы slice-by-16: slices[0] - классическая таблица, slices[k][b] - CRC байта b,
+        // за которым следуют k нулевых байтов. Строятся при компиляции.
+        using crc32_slices_t = std::array<std::array<uint32_t, 256>, 16>;
+
+        constexpr crc32_slices_t make_crc32_slices() {
+            crc32_slices_t t{};
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? (c >> 1) ^ 0xEDB88320u : (c >> 1);
+                }
+                t[0][i] = c;
+            }
+            for (uint32_t i = 0; i < 256; ++i) {
+                for (size_t k = 1; k < 16; ++k) {
+                    t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+                }
+            }
+            return t;
+        }
+
+        inline constexpr crc32_slices_t crc32_slices = make_crc32_slices();
+
+        constexpr uint32_t load_le32(const uint8_t* p) {
+            return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                   (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+
+        // Побайтовый расчёт по crc32_table (эталон); crc - уже инвертированное значение
+        constexpr uint32_t crc32_bytewise(uint32_t crc, const uint8_t* p, size_t len) {
+            for (size_t i = 0; i < len; ++i) {
+                crc = crc32_table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+            }
+            return crc;
+        }
+
+        // Slice-by-16: 16 байт за шаг, независимо от порядка байтов платформы
+        constexpr uint32_t crc32_slice16(uint32_t crc, const uint8_t* p, size_t len) {
+            const auto& t = crc32_slices;
+            while (len >= 16) {
+                const uint32_t a = load_le32(p) ^ crc;
+                const uint32_t b = load_le32(p + 4);
+                const uint32_t c = load_le32(p + 8);
+                const uint32_t d = load_le32(p + 12);
+                crc = t[15][a & 0xFF] ^ t[14][(a >> 8) & 0xFF] ^ t[13][(a >> 16) & 0xFF] ^ t[12][a >> 24] ^
+                      t[11][b & 0xFF] ^ t[10][(b >> 8) & 0xFF] ^ t[9][(b >> 16) & 0xFF]  ^ t[8][b >> 24]  ^
+                      t[7][c & 0xFF]  ^ t[6][(c >> 8) & 0xFF]  ^ t[5][(c >> 16) & 0xFF]  ^ t[4][c >> 24]  ^
+                      t[3][d & 0xFF]  ^ t[2][(d >> 8) & 0xFF]  ^ t[1][(d >> 16) & 0xFF]  ^ t[0][d >> 24];
+                p += 16;
+                len -= 16;
+            }
+            if (len >= 8) {
+                const uint32_t a = load_le32(p) ^ crc;
+                const uint32_t b = load_le32(p + 4);
+                crc = t[7][a & 0xFF] ^ t[6][(a >> 8) & 0xFF] ^ t[5][(a >> 16) & 0xFF] ^ t[4][a >> 24] ^
+                      t[3][b & 0xFF] ^ t[2][(b >> 8) & 0xFF] ^ t[1][(b >> 16) & 0xFF] ^ t[0][b >> 24];
+                p += 8;
+                len -= 8;
+            }
+            return crc32_bytewise(crc, p, len);
+        }
+
+        // Проверки совместимости с прежней реализацией (выполняются компилятором)
+        constexpr bool crc32_slices_match_table() {
+            for (size_t i = 0; i < 256; ++i) {
+                if (crc32_slices[0][i] != crc32_table[i]) return false;
+            }
+            return true;
+        }
+
+        constexpr bool crc32_slice16_matches_bytewise() {
+            std::array<uint8_t, 97> data{};
+            for (size_t i = 0; i < data.size(); ++i) data[i] = static_cast<uint8_t>(i * 131 + 7);
+            for (size_t offset = 0; offset < 16; ++offset) {
+                for (size_t len = 0; offset + len <= data.size(); len += 5) {
+                    if (crc32_slice16(~0u, data.data() + offset, len) !=
+                        crc32_bytewise(~0u, data.data() + offset, len)) return false;
+                }
+            }
+            return true;
+        }
+
+        constexpr uint8_t crc32_check_input[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+        static_assert(crc32_slices_match_table(), "CRC32 slice tables differ from crc32_table");
+        static_assert(~crc32_slice16(~0u, crc32_check_input, sizeof(crc32_check_input)) == 0xCBF43926u,
+                      "CRC32 check value mismatch");
+        static_assert(crc32_slice16_matches_bytewise(), "CRC32 slice-by-16 differs from table implementation");
+
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+    #define UTILS_CRC32_PCLMUL 1
+
+        // Свёртка PCLMULQDQ (Intel, "Fast CRC Computation Using PCLMULQDQ Instruction"; константы
+        // для отражённого полинома 0xEDB88320 - как в zlib/Chromium crc32_simd).
+        // len >= 64 и кратна 16; crc - уже инвертированное значение
+#if defined(__GNUC__) || defined(__clang__)
+        __attribute__((target("pclmul,sse4.1")))
+#endif
+        inline uint32_t crc32_pclmul(uint32_t crc, const uint8_t* buf, size_t len) {
+            alignas(16) static const uint64_t k1k2[] = {0x0154442bd4, 0x01c6e41596};
+            alignas(16) static const uint64_t k3k4[] = {0x01751997d0, 0x00ccaa009e};
+            alignas(16) static const uint64_t k5k0[] = {0x0163cd6124, 0x0000000000};
+            alignas(16) static const uint64_t poly[] = {0x01db710641, 0x01f7011641};
+
+            __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+            x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x00));
+            x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x10));
+            x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x20));
+            x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x30));
+            x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+            x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+            buf += 64;
+            len -= 64;
+
+            // Параллельная свёртка блоков по 64 байта
+            while (len >= 64) {
+                x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+                x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+                x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+                x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+                x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+                x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+                x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+                x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+                y5 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x00));
+                y6 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x10));
+                y7 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x20));
+                y8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x30));
+
+                x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+                x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+                x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+                x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+                buf += 64;
+                len -= 64;
+            }
+
+            // Свёртка четырёх регистров в один
+            x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+            for (__m128i next : {x2, x3, x4}) {
+                x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+                x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+                x1 = _mm_xor_si128(_mm_xor_si128(x1, next), x5);
+            }
+
+            // Оставшиеся блоки по 16 байт
+            while (len >= 16) {
+                x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+                x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+                x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+                x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+                buf += 16;
+                len -= 16;
+            }
+
+            // 128 -> 64 бита
+            x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+            x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+            x1 = _mm_srli_si128(x1, 8);
+            x1 = _mm_xor_si128(x1, x2);
+
+            x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+            x2 = _mm_srli_si128(x1, 4);
+            x1 = _mm_and_si128(x1, x3);
+            x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+            x1 = _mm_xor_si128(x1, x2);
+
+            // Редукция Барретта до 32 бит
+            x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+            x2 = _mm_and_si128(x1, x3);
+            x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+            x2 = _mm_and_si128(x2, x3);
+            x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+            x1 = _mm_xor_si128(x1, x2);
+
+            return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+        }
+
+        // Поддержка PCLMULQDQ и SSE4.1 определяется один раз при первом вызове
+        inline bool has_pclmul() {
+            static const bool supported = [] {
+#if defined(_MSC_VER) && !defined(__clang__)
+                int info[4];
+                __cpuid(info, 1);
+                return (info[2] & (1 << 1)) != 0 && (info[2] & (1 << 19)) != 0;
+#else
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+#endif
+            }();
+            return supported;
+        }
+#endif
+
+        // Один шаг расчёта над инвертированным значением crc
+        inline uint32_t crc32_update(uint32_t crc, const uint8_t* bytes, size_t length) {
+#ifdef UTILS_CRC32_PCLMUL
+            if (length >= 64 && has_pclmul()) {
+                const size_t folded = length & ~static_cast<size_t>(15);
+                crc = crc32_pclmul(crc, bytes, folded);
+                bytes += folded;
+                length -= folded;
+            }
+#endif
+            return crc32_slice16(crc, bytes, length);
+        }
+    } // namespace detail
+
     // Кроссплатформенная функция расчета CRC32
+    // (PCLMULQDQ на x86-64 при поддержке процессором, иначе slice-by-16; результат одинаков)
     inline uint32_t calculate_crc32(const void* data, size_t length, uint32_t crc = 0) {
         const uint8_t* bytes = static_cast<const uint8_t*>(data);
-        crc = ~crc; // Инвертируем начальное значение
+        return ~detail::crc32_update(~crc, bytes, length); // Инверсия на входе и выходе
+    }
 
-        for (size_t i = 0; i < length; ++i) {
-            crc = crc32_table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    // Инкрементальный расчёт CRC32: данные подаются частями по мере чтения/отправки.
+    // Результат совпадает с calculate_crc32 для всех данных целиком.
+    class Crc32 {
+    public:
+        void update(const void* data, size_t length) {
+            state_ = detail::crc32_update(state_, static_cast<const uint8_t*>(data), length);
         }
 
-        return ~crc; // Финализируем инверсией
-    }
+        [[nodiscard]] uint32_t value() const { return ~state_; }
 
-    // Кроссплатформенная функция расчета CRC32 файла
-    inline uint32_t calculate_file_crc32(const std::filesystem::path& filepath) {
-        std::ifstream file(filepath, std::ios::binary | std::ios::ate);
-        if (!file) {
-            throw std::runtime_error("Cannot open file: " + filepath.string());
+        void reset() { state_ = ~0u; }
+
+    private:
+        uint32_t state_ = ~0u;     // Инвертированное значение
+    };
+
+    // Слабая скользящая контрольная сумма блока (как в rsync): сумма байтов и сумма префиксных
+    // сумм по модулю 2^16. Окно сдвигается на байт за O(1), что позволяет искать блок
+    // по любому смещению; совпадение подтверждается сильной суммой (CRC32).
+    class RollingChecksum {
+    public:
+        RollingChecksum() = default;
+        RollingChecksum(const void* data, size_t length) { reset(data, length); }
+
+        void reset(const void* data, size_t length) {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            a_ = 0;
+            b_ = 0;
+            length_ = length;
+            for (size_t i = 0; i < length; ++i) {
+                a_ += bytes[i];
+                b_ += static_cast<uint32_t>(length - i) * bytes[i];
+            }
         }
 
-        // Получаем размер файла
-        const auto file_size = file.tellg();
-        file.seekg(0, std::ios::beg);
+        // Сдвиг окна на один байт: out покидает окно, in добавляется в конец
+        void roll(uint8_t out, uint8_t in) {
+            a_ += static_cast<uint32_t>(in) - out;
+            b_ += a_ - static_cast<uint32_t>(length_) * out;
+        }
+
+        [[nodiscard]] uint32_t value() const { return (a_ & 0xFFFF) | (b_ << 16); }
+
+    private:
+        uint32_t a_ = 0;
+        uint32_t b_ = 0;
+        size_t length_ = 0;
+    };
 
-        // Читаем файл целиком для гарантии одинакового результата на всех платформах
-        std::vector<uint8_t> buffer(file_size);
-        if (!file.read(reinterpret_cast<char*>(buffer.data()), file_size)) {
-            throw std::runtime_error("Failed to read file: " + filepath.string());
+    // CRC32 отображённого в память файла (исключение, если файл укорочен после отображения)
+    inline uint32_t calculate_file_crc32(const MappedFile& file) {
+        if (file.truncated()) {
+            throw std::runtime_error("File was truncated while mapped: " + file.path().string());
         }
+        return calculate_crc32(file.data(), file.size());
+    }
 
-        return calculate_crc32(buffer.data(), buffer.size());
+    // Кроссплатформенная функция расчета CRC32 файла
+    inline uint32_t calculate_file_crc32(const std::filesystem::path& filepath) {
+        // Файл отображается в память целиком: одинаковый результат на всех платформах без копирования
+        return calculate_file_crc32(MappedFile(filepath));
     }
 
     // Кроссплатформенная функция расчета хеша программы
@@ -215,95 +478,315 @@ namespace utils
             "abcdefghijklmnopqrstuvwxyz"
             "0123456789+/";
 
-    std::string base64_encode(const unsigned char* bytes_to_encode, size_t in_len) {
-        std::string ret;
-        int i = 0;
-        int j = 0;
-        unsigned char char_array_3[3];
-        unsigned char char_array_4[4];
-
-        while (in_len--) {
-            char_array_3[i++] = *(bytes_to_encode++);
-            if (i == 3) {
-                char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-                char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-                char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-                char_array_4[3] = char_array_3[2] & 0x3f;
-
-                for(i = 0; (i <4) ; i++)
-                    ret += base64_chars[char_array_4[i]];
-                i = 0;
-            }
+    namespace detail
+    {
+        inline constexpr char base64_alphabet[] =
+                "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        // Обратная таблица: значение символа или 0xFF для символов вне алфавита (в т.ч. '=')
+        constexpr std::array<uint8_t, 256> make_base64_decode_table() {
+            std::array<uint8_t, 256> t{};
+            for (auto& v : t) v = 0xFF;
+            for (uint8_t i = 0; i < 64; ++i) t[static_cast<uint8_t>(base64_alphabet[i])] = i;
+            return t;
         }
 
-        if (i) {
-            for(j = i; j < 3; j++)
-                char_array_3[j] = '\0';
+        inline constexpr std::array<uint8_t, 256> base64_decode_table = make_base64_decode_table();
+
+        // Полные тройки байтов, начиная с in[i]; возвращает позицию первой необработанной
+        inline size_t base64_encode_scalar(const uint8_t* in, size_t i, size_t len, char* out) {
+            for (; i + 3 <= len; i += 3) {
+                const uint32_t v = (static_cast<uint32_t>(in[i]) << 16) |
+                                   (static_cast<uint32_t>(in[i + 1]) << 8) | in[i + 2];
+                char* o = out + i / 3 * 4;
+                o[0] = base64_alphabet[v >> 18];
+                o[1] = base64_alphabet[(v >> 12) & 0x3F];
+                o[2] = base64_alphabet[(v >> 6) & 0x3F];
+                o[3] = base64_alphabet[v & 0x3F];
+            }
+            return i;
+        }
 
-            char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-            char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-            char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-            char_array_4[3] = char_array_3[2] & 0x3f;
+        // Полные четвёрки символов до первого символа вне алфавита;
+        // возвращает позицию первой необработанной четвёрки
+        inline size_t base64_decode_scalar(const uint8_t* in, size_t i, size_t len, uint8_t* out, size_t& out_len) {
+            for (; i + 4 <= len; i += 4) {
+                const uint32_t a = base64_decode_table[in[i]];
+                const uint32_t b = base64_decode_table[in[i + 1]];
+                const uint32_t c = base64_decode_table[in[i + 2]];
+                const uint32_t d = base64_decode_table[in[i + 3]];
+                if ((a | b | c | d) & 0x80) break;
+                const uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+                out[out_len++] = static_cast<uint8_t>(v >> 16);
+                out[out_len++] = static_cast<uint8_t>(v >> 8);
+                out[out_len++] = static_cast<uint8_t>(v);
+            }
+            return i;
+        }
 
-            for (j = 0; (j < i + 1); j++)
-                ret += base64_chars[char_array_4[j]];
+        enum class SimdLevel { None, Ssse3, Avx2 };
+
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+    #define UTILS_BASE64_SIMD 1
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define UTILS_TARGET_SSSE3 __attribute__((target("ssse3")))
+    #define UTILS_TARGET_AVX2  __attribute__((target("avx2")))
+#else
+    #define UTILS_TARGET_SSSE3
+    #define UTILS_TARGET_AVX2
+#endif
+
+        // Векторный base64 по схеме В. Мулы (см. также aklomp/base64): 12 байт -> 16 символов
+        // (AVX2 - 24 -> 32) с переводом 6-битных значений в символы через pshufb.
+        // Декодер проверяет символы блока целиком и при любом символе вне алфавита
+        // отдаёт остаток скалярному коду, который и определяет точное место остановки.
+
+        UTILS_TARGET_SSSE3 inline __m128i base64_enc_reshuffle(__m128i in) {
+            in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+            const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+            const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+            const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+            const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+            return _mm_or_si128(t1, t3);
+        }
 
-            while((i++ < 3))
-                ret += '=';
+        UTILS_TARGET_SSSE3 inline __m128i base64_enc_translate(__m128i in) {
+            const __m128i lut = _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+            __m128i indices = _mm_subs_epu8(in, _mm_set1_epi8(51));
+            indices = _mm_sub_epi8(indices, _mm_cmpgt_epi8(in, _mm_set1_epi8(25)));
+            return _mm_add_epi8(in, _mm_shuffle_epi8(lut, indices));
         }
 
-        return ret;
-    }
+        UTILS_TARGET_SSSE3 inline size_t base64_encode_ssse3(const uint8_t* in, size_t len, char* out) {
+            size_t i = 0;
+            for (; i + 16 <= len; i += 12) {   // Читается 16 байт, используется 12
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                v = base64_enc_translate(base64_enc_reshuffle(v));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i / 3 * 4), v);
+            }
+            return i;
+        }
 
-    inline std::string base64_encode(const std::string& str) {
-        return base64_encode(reinterpret_cast<const unsigned char*>(str.c_str()), str.size());
-    }
+        UTILS_TARGET_AVX2 inline size_t base64_encode_avx2(const uint8_t* in, size_t len, char* out) {
+            const __m256i shuffle = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+                                                    10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+            const __m256i lut = _mm256_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0,
+                                                 65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+            size_t i = 0;
+            for (; i + 28 <= len; i += 24) {   // Две половины по 12 байт, каждая читается по 16
+                __m256i v = _mm256_inserti128_si256(
+                        _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))),
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 12)), 1);
+                v = _mm256_shuffle_epi8(v, shuffle);
+                const __m256i t0 = _mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00));
+                const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+                const __m256i t2 = _mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0));
+                const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+                v = _mm256_or_si256(t1, t3);
+
+                __m256i indices = _mm256_subs_epu8(v, _mm256_set1_epi8(51));
+                indices = _mm256_sub_epi8(indices, _mm256_cmpgt_epi8(v, _mm256_set1_epi8(25)));
+                v = _mm256_add_epi8(v, _mm256_shuffle_epi8(lut, indices));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i / 3 * 4), v);
+            }
+            return i;
+        }
 
-    inline bool is_base64(unsigned char c) {
-        return (isalnum(c) || (c == '+') || (c == '/'));
-    }
+        // Пишет 16 байт на каждые 12 декодированных: в out нужен запас
+        UTILS_TARGET_SSSE3 inline size_t base64_decode_ssse3(const uint8_t* in, size_t len, uint8_t* out, size_t& out_len) {
+            const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                                 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+            const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                                 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+            const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+            const __m128i mask_2f = _mm_set1_epi8(0x2F);
+            const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+            size_t i = 0;
+            for (; i + 16 <= len; i += 16) {
+                __m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask_2f);
+                const __m128i lo_nibbles = _mm_and_si128(str, mask_2f);
+                const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+                const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+                if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0) break;
+
+                const __m128i eq_2f = _mm_cmpeq_epi8(str, mask_2f);
+                str = _mm_add_epi8(str, _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles)));
+                str = _mm_maddubs_epi16(str, _mm_set1_epi32(0x01400140));
+                str = _mm_madd_epi16(str, _mm_set1_epi32(0x00011000));
+                str = _mm_shuffle_epi8(str, pack);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + out_len), str);
+                out_len += 12;
+            }
+            return i;
+        }
 
-    std::string base64_decode(const std::string& encoded_string) {
-        size_t in_len = encoded_string.size();
-        int i = 0;
-        int j = 0;
-        int in_ = 0;
-        unsigned char char_array_4[4], char_array_3[3];
-        std::string ret;
-
-        while (in_len-- && (encoded_string[in_] != '=') && is_base64(encoded_string[in_])) {
-            char_array_4[i++] = encoded_string[in_]; in_++;
-            if (i == 4) {
-                for (i = 0; i <4; i++)
-                    char_array_4[i] = base64_chars.find(char_array_4[i]);
-
-                char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-                char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-                char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-
-                for (i = 0; (i < 3); i++)
-                    ret += char_array_3[i];
-                i = 0;
+        // Пишет 32 байта на каждые 24 декодированных: в out нужен запас
+        UTILS_TARGET_AVX2 inline size_t base64_decode_avx2(const uint8_t* in, size_t len, uint8_t* out, size_t& out_len) {
+            const __m256i lut_lo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                                    0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+                                                    0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                                    0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+            const __m256i lut_hi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                                    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                                    0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                                    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+            const __m256i lut_roll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                      0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+            const __m256i mask_2f = _mm256_set1_epi8(0x2F);
+            const __m256i pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                  2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+            size_t i = 0;
+            for (; i + 32 <= len; i += 32) {
+                __m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+                const __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask_2f);
+                const __m256i lo_nibbles = _mm256_and_si256(str, mask_2f);
+                const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+                const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+                if (!_mm256_testz_si256(lo, hi)) break;
+
+                const __m256i eq_2f = _mm256_cmpeq_epi8(str, mask_2f);
+                str = _mm256_add_epi8(str, _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles)));
+                str = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+                str = _mm256_madd_epi16(str, _mm256_set1_epi32(0x00011000));
+                str = _mm256_shuffle_epi8(str, pack);
+                str = _mm256_permutevar8x32_epi32(str, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + out_len), str);
+                out_len += 24;
             }
+            return i;
         }
 
-        if (i) {
-            for (j = i; j <4; j++)
-                char_array_4[j] = 0;
+        // Доступный набор инструкций определяется один раз при первом вызове
+        inline SimdLevel simd_level() {
+            static const SimdLevel level = [] {
+#if defined(_MSC_VER) && !defined(__clang__)
+                int info[4];
+                __cpuid(info, 1);
+                const bool ssse3 = (info[2] & (1 << 9)) != 0;
+                const bool osxsave = (info[2] & (1 << 27)) != 0;
+                bool avx2 = false;
+                if (osxsave && (_xgetbv(0) & 6) == 6) {
+                    __cpuidex(info, 7, 0);
+                    avx2 = (info[1] & (1 << 5)) != 0;
+                }
+#else
+                __builtin_cpu_init();
+                const bool ssse3 = __builtin_cpu_supports("ssse3");
+                const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+                return avx2 ? SimdLevel::Avx2 : ssse3 ? SimdLevel::Ssse3 : SimdLevel::None;
+            }();
+            return level;
+        }
+#else
+        inline SimdLevel simd_level() { return SimdLevel::None; }
+#endif
+
+        // Кодирование с заданным набором инструкций (не выше simd_level()); используется тестами
+        inline std::string base64_encode(const unsigned char* bytes_to_encode, size_t in_len, SimdLevel level) {
+            std::string ret((in_len + 2) / 3 * 4, '\0');
+            char* out = ret.data();
+            size_t i = 0;
+
+#ifdef UTILS_BASE64_SIMD
+            switch (level) {
+                case SimdLevel::Avx2:
+                    i = base64_encode_avx2(bytes_to_encode, in_len, out);
+                    [[fallthrough]];
+                case SimdLevel::Ssse3:
+                    i += base64_encode_ssse3(bytes_to_encode + i, in_len - i, out + i / 3 * 4);
+                    break;
+                case SimdLevel::None:
+                    break;
+            }
+#endif
+            i = base64_encode_scalar(bytes_to_encode, i, in_len, out);
+
+            if (const size_t rest = in_len - i; rest > 0) {
+                const uint32_t v = (static_cast<uint32_t>(bytes_to_encode[i]) << 16) |
+                                   (rest > 1 ? static_cast<uint32_t>(bytes_to_encode[i + 1]) << 8 : 0);
+                char* o = out + i / 3 * 4;
+                o[0] = base64_alphabet[v >> 18];
+                o[1] = base64_alphabet[(v >> 12) & 0x3F];
+                o[2] = rest > 1 ? base64_alphabet[(v >> 6) & 0x3F] : '=';
+                o[3] = '=';
+            }
 
-            for (j = 0; j <4; j++)
-                char_array_4[j] = base64_chars.find(char_array_4[j]);
+            return ret;
+        }
 
-            char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-            char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-            char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+        // Декодирование с заданным набором инструкций (не выше simd_level()); используется тестами
+        inline std::string base64_decode(const std::string& encoded_string, SimdLevel level) {
+            const auto* in = reinterpret_cast<const uint8_t*>(encoded_string.data());
+            const size_t in_len = encoded_string.size();
+
+            // Запас 32 байта: векторный код пишет блоками больше полезного результата
+            std::string ret(in_len / 4 * 3 + 3 + 32, '\0');
+            auto* out = reinterpret_cast<uint8_t*>(ret.data());
+            size_t out_len = 0;
+            size_t i = 0;
+
+#ifdef UTILS_BASE64_SIMD
+            switch (level) {
+                case SimdLevel::Avx2:
+                    i = base64_decode_avx2(in, in_len, out, out_len);
+                    [[fallthrough]];
+                case SimdLevel::Ssse3:
+                    i += base64_decode_ssse3(in + i, in_len - i, out, out_len);
+                    break;
+                case SimdLevel::None:
+                    break;
+            }
+#endif
+            i = base64_decode_scalar(in, i, in_len, out, out_len);
+
+            // Неполная четвёрка (или полная, прерванная символом вне алфавита)
+            uint32_t v = 0;
+            size_t n = 0;
+            for (; n < 4 && i + n < in_len; ++n) {
+                const uint8_t d = base64_decode_table[in[i + n]];
+                if (d & 0x80) break;
+                v |= static_cast<uint32_t>(d) << (18 - 6 * n);
+            }
+            for (size_t k = 0; k + 1 < n; ++k) {
+                out[out_len++] = static_cast<uint8_t>(v >> (16 - 8 * k));
+            }
 
-            for (j = 0; (j < i - 1); j++)
-                ret += char_array_3[j];
+            ret.resize(out_len);
+            return ret;
         }
+    } // namespace detail
+
+    /**
+     * @brief Кодирование base64 (с дополнением '=')
+     *
+     * Результат выделяется один раз; основной объём на x86-64 кодируется AVX2/SSSE3,
+     * хвост - скалярно. Вывод побайтно совпадает с прежней реализацией.
+     */
+    inline std::string base64_encode(const unsigned char* bytes_to_encode, size_t in_len) {
+        return detail::base64_encode(bytes_to_encode, in_len, detail::simd_level());
+    }
+
+    inline std::string base64_encode(const std::string& str) {
+        return base64_encode(reinterpret_cast<const unsigned char*>(str.c_str()), str.size());
+    }
 
-        return ret;
+    inline bool is_base64(unsigned char c) {
+        return (isalnum(c) || (c == '+') || (c == '/'));
     }
 
+    /**
+     * @brief Декодирование base64
+     *
+     * Как и прежде, разбор останавливается на первом '=' или символе вне алфавита;
+     * неполная последняя четвёрка из n символов даёт n - 1 байт.
+     */
+    inline std::string base64_decode(const std::string& encoded_string) {
+        return detail::base64_decode(encoded_string, detail::simd_level());
+    }
 
 } // namespace utils
\ No newline at end of file
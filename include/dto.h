@@ -5,9 +5,15 @@
 
 //#include "variant.h"
 #include <string>
+#include <string_view>
 #include <vector>
+#include <algorithm>
 #include <utility>
 #include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
@@ -99,6 +105,8 @@ struct Request : public IDto
 {
     std::string key;
     std::string request;
+    uint64_t    id = 0;     // Идентификатор корреляции (0 - не задан), сервер возвращает его в ответе
+
     Request(std::string k, std::string r): key(std::move(k)), request(std::move(r)) {}
 
     [[nodiscard]] std::string getKey() const override { return key; }
@@ -106,15 +114,23 @@ struct Request : public IDto
         json j;
         j["key"] = key;
         j["request"] = request;
+        putId(j);
         return j.dump();
     }
 
     static Request fromJSON(const std::string& jsonStr) {
         auto j = json::parse(jsonStr);
-        return Request{
+        Request r{
             j["key"].get<std::string>(),
             j["request"].get<std::string>()
         };
+        r.id = j.value("id", uint64_t{0});
+        return r;
+    }
+
+protected:
+    void putId(json& j) const {
+        if (id != 0) j["id"] = id;
     }
 };
 
@@ -132,6 +148,8 @@ struct Response : public IDto
     std::string request = "unknown";
     int         result = SUCCESS;
     std::string message = "unknown";
+    uint64_t    id = 0;     // Идентификатор корреляции из запроса (0 - сервер его не вернул)
+    json        data;       // Дополнительные данные ответа (null - нет)
 
     Response() = default;
     Response(std::string key_, std::string req, int res, std::string m) :
@@ -147,17 +165,22 @@ struct Response : public IDto
         j["request"] = request;
         j["result"]  = result;
         j["message"] = message;
+        if (id != 0) j["id"] = id;
+        if (!data.is_null()) j["data"] = data;
         return j.dump();
     }
 
     static Response fromJSON(const std::string& jsonStr) {
         auto j = json::parse(jsonStr);
-        return Response{
+        Response r{
                 j["key"].get<std::string>(),
                 j["request"].get<std::string>(),
                 j["result"].get<int>(),
                 j["message"].get<std::string>()
         };
+        r.id = j.value("id", uint64_t{0});
+        if (auto it = j.find("data"); it != j.end()) r.data = std::move(*it);
+        return r;
     }
 
     [[nodiscard]] bool isSuccess() const { return result >= 200 && result < 300; }
@@ -205,16 +228,19 @@ struct Subscribe : public Request
         j["request"] = request;
         j["topic"]   = topic;
         j["keys"]    = keys;
+        putId(j);
         return j.dump();
     }
 
     static Subscribe fromJSON(const std::string& jsonStr) {
         auto j = json::parse(jsonStr);
-        return Subscribe{
+        Subscribe r{
                 j["key"].get<std::string>(),
                 j["topic"].get<std::string>(),
                 j["keys"].get<std::vector<std::string>>()
         };
+        r.id = j.value("id", uint64_t{0});
+        return r;
     }
 };
 
@@ -232,21 +258,163 @@ struct Unsubscribe : public Request {
         j["key"]     = key;
         j["request"] = request;
         j["topic"]   = topic;
+        putId(j);
         return j.dump();
     }
 
     static Unsubscribe fromJSON(const std::string& jsonStr) {
         auto j = json::parse(jsonStr);
-        return Unsubscribe{
+        Unsubscribe r{
                 j["key"].get<std::string>(),
                 j["topic"].get<std::string>()
         };
+        r.id = j.value("id", uint64_t{0});
+        return r;
     }
 };
 
+// Словарь интернированных имён тегов (для двоичного формата SendValues)
+// ----------------------------------------------------------------------------
+// Имя тега передаётся вместе с id при первом появлении тега и повторно - не реже чем раз
+// в resend_interval кадров, в остальных кадрах - только числовой id. PUB/SUB не гарантирует
+// доставку, а общий PUB не может сбросить словарь отдельному подписчику: получатель, потерявший
+// кадр с определением или подключившийся позже, узнаёт имя из очередного повтора.
+class TagDictionary {
+    static constexpr uint32_t MAX_ID = 1u << 24;    // Защита от некорректных кадров
+
+    struct Entry {
+        uint32_t id;
+        uint64_t sent_frame;    // Кадр, в котором имя передавалось последним
+    };
+
+    std::unordered_map<std::string, Entry> ids_;
+    std::vector<std::string>               names_;
+    uint64_t                               frame_ = 0;
+    uint64_t                               resend_interval_;
+
+public:
+    static constexpr uint64_t DEFAULT_RESEND_INTERVAL = 64;
+
+    // resend_interval - число кадров между повторами имени (1 - имя в каждом кадре)
+    explicit TagDictionary(uint64_t resend_interval = DEFAULT_RESEND_INTERVAL)
+            : resend_interval_(std::max<uint64_t>(resend_interval, 1)) {}
+
+    // Для отправителя: начало очередного кадра
+    void next_frame() { ++frame_; }
+
+    // Для отправителя: id тега и признак того, что имя нужно передать в этом кадре
+    std::pair<uint32_t, bool> intern(const std::string& name) {
+        auto [it, inserted] = ids_.try_emplace(name, Entry{static_cast<uint32_t>(names_.size()), frame_});
+        if (inserted) {
+            names_.push_back(name);
+            return {it->second.id, true};
+        }
+        const bool resend = frame_ - it->second.sent_frame >= resend_interval_;
+        if (resend) it->second.sent_frame = frame_;
+        return {it->second.id, resend};
+    }
+
+    // Для получателя: запомнить имя, пришедшее вместе с id
+    void define(uint32_t id, std::string_view name) {
+        if (id >= MAX_ID) throw std::runtime_error("TagDictionary: tag id out of range");
+        if (id >= names_.size()) names_.resize(id + 1);
+        names_[id].assign(name.data(), name.size());
+    }
+
+    // Для получателя: имя по id (nullptr - id ещё не определён)
+    [[nodiscard]] const std::string* find(uint32_t id) const {
+        return id < names_.size() && !names_[id].empty() ? &names_[id] : nullptr;
+    }
+
+    void clear() {
+        ids_.clear();
+        names_.clear();
+        frame_ = 0;
+    }
+};
+
+// Двоичная сериализация (little-endian, фиксированная ширина полей)
+// ----------------------------------------------------------------------------
+namespace wire {
+    inline void put_u8(std::string& out, uint8_t v) { out.push_back(static_cast<char>(v)); }
+
+    inline void put_u16(std::string& out, uint16_t v) {
+        for (int i = 0; i < 2; ++i) out.push_back(static_cast<char>(v >> (8 * i)));
+    }
+
+    inline void put_u32(std::string& out, uint32_t v) {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>(v >> (8 * i)));
+    }
+
+    inline void put_u64(std::string& out, uint64_t v) {
+        for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>(v >> (8 * i)));
+    }
+
+    inline void put_str(std::string& out, std::string_view s) {
+        if (s.size() > UINT16_MAX) throw std::length_error("wire: string too long");
+        put_u16(out, static_cast<uint16_t>(s.size()));
+        out.append(s.data(), s.size());
+    }
+
+    // Последовательное чтение с проверкой границ
+    class Reader {
+        const uint8_t* pos_;
+        const uint8_t* end_;
+
+        const uint8_t* take(size_t n) {
+            if (static_cast<size_t>(end_ - pos_) < n) {
+                throw std::runtime_error("wire: truncated binary frame");
+            }
+            const uint8_t* p = pos_;
+            pos_ += n;
+            return p;
+        }
+
+        template <typename T>
+        T get_le() {
+            const uint8_t* p = take(sizeof(T));
+            T v = 0;
+            for (size_t i = 0; i < sizeof(T); ++i) v |= static_cast<T>(p[i]) << (8 * i);
+            return v;
+        }
+
+    public:
+        Reader(const void* data, size_t size)
+                : pos_(static_cast<const uint8_t*>(data)),
+                  end_(static_cast<const uint8_t*>(data) + size) {}
+
+        uint8_t  u8()  { return *take(1); }
+        uint16_t u16() { return get_le<uint16_t>(); }
+        uint32_t u32() { return get_le<uint32_t>(); }
+        uint64_t u64() { return get_le<uint64_t>(); }
+
+        std::string_view str() {
+            const uint16_t n = u16();
+            return {reinterpret_cast<const char*>(take(n)), n};
+        }
+
+        [[nodiscard]] bool empty() const { return pos_ == end_; }
+        [[nodiscard]] size_t remaining() const { return static_cast<size_t>(end_ - pos_); }
+    };
+} // namespace wire
+
 // SendValues (отправка изменений)
 // ----------------------------------------------------------------------------
+// Поддерживаются два формата: JSON (по умолчанию) и компактный двоичный,
+// который клиент запрашивает при connect ("pub_formats"). Формат кадра определяется
+// по первому байту (см. isBinary), поэтому JSON остаётся запасным вариантом.
+// Публикация передаётся двумя кадрами: topicFrame(key, topic) и само сообщение.
+//
+// Двоичный кадр:
+//   magic[3] = B5 'S' 'V' | u8 version | str key | str topic | u32 count | count * tag
+//   tag: u32 id | u8 flags | [str name, если flags & NEW_NAME] | u64 value | u8 quality | i64 timestamp_ms
+// str - u16 длина + байты.
 struct SendValues : public IDto {
+    static constexpr uint8_t BINARY_MAGIC[3] = {0xB5, 'S', 'V'};
+    static constexpr uint8_t BINARY_VERSION  = 1;
+    static constexpr uint8_t NEW_NAME        = 0x01;
+    static constexpr size_t  MIN_BINARY_TAG_SIZE = 4 + 1 + 8 + 1 + 8;   // Тег без имени
+
     std::string      key;
     std::string      topic;
     std::vector<Tag> values;
@@ -285,13 +453,105 @@ struct SendValues : public IDto {
                 std::move(values)
         };
     }
+
+    // Первый кадр публикации: "<key>/<topic>\0". По нему работает префиксная подписка ZMQ,
+    // и чужие публикации отбрасываются ещё в libzmq, до разбора. Завершающий '\0' входит
+    // в префикс подписки: без него подписка на "default" принимала бы и "default_topic".
+    // Одна функция формирует кадр и на сервере, и на клиенте
+    static std::string topicFrame(const std::string& key, const std::string& topic) {
+        std::string frame;
+        frame.reserve(key.size() + topic.size() + 2);
+        frame.append(key).append(1, '/').append(topic).append(1, '\0');
+        return frame;
+    }
+
+    static bool isBinary(const void* data, size_t size) {
+        const auto* p = static_cast<const uint8_t*>(data);
+        return size >= 4 && p[0] == BINARY_MAGIC[0] && p[1] == BINARY_MAGIC[1] && p[2] == BINARY_MAGIC[2];
+    }
+
+    [[nodiscard]] std::string toBinary(TagDictionary& dictionary) const {
+        std::string out;
+        out.reserve(16 + key.size() + topic.size() + values.size() * 26);
+        out.append(reinterpret_cast<const char*>(BINARY_MAGIC), sizeof(BINARY_MAGIC));
+        wire::put_u8(out, BINARY_VERSION);
+        wire::put_str(out, key);
+        wire::put_str(out, topic);
+        wire::put_u32(out, static_cast<uint32_t>(values.size()));
+        dictionary.next_frame();
+        for (const auto& tag : values) {
+            auto [id, is_new] = dictionary.intern(tag.key);
+            wire::put_u32(out, id);
+            wire::put_u8(out, is_new ? NEW_NAME : 0);
+            if (is_new) wire::put_str(out, tag.key);
+            wire::put_u64(out, tag.value);
+            wire::put_u8(out, static_cast<uint8_t>(tag.quality));
+            wire::put_u64(out, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    tag.timestamp.time_since_epoch()).count()));
+        }
+        return out;
+    }
+
+    // Теги с id, имя которых получателю неизвестно (кадр с определением был потерян), пропускаются
+    // до ближайшего повтора имени (см. TagDictionary)
+    static SendValues fromBinary(const void* data, size_t size, TagDictionary& dictionary) {
+        wire::Reader in(data, size);
+        for (uint8_t b : BINARY_MAGIC) {
+            if (in.u8() != b) throw std::runtime_error("SendValues: bad binary magic");
+        }
+        if (in.u8() != BINARY_VERSION) throw std::runtime_error("SendValues: unsupported binary version");
+
+        std::string k{in.str()};
+        std::string t{in.str()};
+        const uint32_t count = in.u32();
+
+        // Число тегов из заголовка не больше, чем помещается в кадр: иначе повреждённый
+        // кадр заставил бы выделить память под миллиарды тегов до обнаружения усечения
+        std::vector<Tag> tags;
+        tags.reserve(std::min<size_t>(count, in.remaining() / MIN_BINARY_TAG_SIZE));
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint32_t id = in.u32();
+            const uint8_t flags = in.u8();
+            if (flags & NEW_NAME) dictionary.define(id, in.str());
+
+            const uint64_t value = in.u64();
+            const uint8_t quality = in.u8();
+            const auto timestamp = static_cast<int64_t>(in.u64());
+
+            if (const std::string* name = dictionary.find(id)) {
+                Tag tag;
+                tag.key = *name;
+                tag.value = value;
+                tag.quality = fromInt(quality);
+                tag.timestamp = sysclk::time_point(std::chrono::milliseconds(timestamp));
+                tags.push_back(std::move(tag));
+            }
+        }
+
+        return SendValues{std::move(k), std::move(t), std::move(tags)};
+    }
 };
 
 // File transfer Management
 // ----------------------------------------------------------------------------
+// Хеш программы передаётся либо сразу в prog_start, либо (hash_trailer == true)
+// в prog_end: клиент рассчитывает его по ходу отправки файлов за один проход.
+// base_hash - хеш ранее загруженной версии программы, относительно которой файлы
+// могут передаваться дельтой (см. BlockQuery).
+// files - манифест программы (имя, размер и CRC32 каждого файла). Получив его, сервер
+// отвечает data.need - именами файлов, которых у него нет; остальные файлы не передаются.
 struct ProgStart : public Request {
+    struct FileEntry {
+        std::string name;
+        uint64_t    size;
+        uint32_t    crc;
+    };
+
     std::string prog_name;
     uint64_t prog_hash;
+    bool     hash_trailer = false;  // Хеш придёт в ProgEnd, prog_hash не передаётся
+    std::optional<uint64_t> base_hash;
+    std::vector<FileEntry>  files;
 
     ProgStart(std::string clientKey, std::string name, uint64_t hash):
             Request(std::move(clientKey), "prog_start"),
@@ -303,23 +563,128 @@ struct ProgStart : public Request {
         j["key"]       = key;
         j["request"]   = request;
         j["prog_name"] = prog_name;
-        j["prog_hash"] = prog_hash;
+        if (hash_trailer) j["prog_hash_trailer"] = true;
+        else              j["prog_hash"] = prog_hash;
+        if (base_hash) j["base_hash"] = *base_hash;
+        if (!files.empty()) {
+            auto& list = j["files"] = json::array();
+            for (const auto& f : files) list.push_back({{"name", f.name}, {"size", f.size}, {"crc", f.crc}});
+        }
+        putId(j);
         return j.dump();
     }
 
     static ProgStart fromJSON(const std::string& jsonStr) {
         auto j = json::parse(jsonStr);
-        return ProgStart{
+        ProgStart r{
                 j["key"].get<std::string>(),
                 j["prog_name"].get<std::string>(),
-                j["prog_hash"].get<uint64_t>()
+                j.value("prog_hash", uint64_t{0})
+        };
+        r.hash_trailer = j.value("prog_hash_trailer", false);
+        if (j.contains("base_hash")) r.base_hash = j["base_hash"].get<uint64_t>();
+        if (j.contains("files")) {
+            for (const auto& f : j["files"]) {
+                r.files.push_back({f["name"].get<std::string>(), f["size"].get<uint64_t>(),
+                                   f["crc"].get<uint32_t>()});
+            }
+        }
+        r.id = j.value("id", uint64_t{0});
+        return r;
+    }
+
+    // Файлы, которые нужно передать (data.need); nullopt - сервер манифест не поддерживает
+    static std::optional<std::vector<std::string>> need(const Response& response) {
+        if (!response.data.is_object()) return std::nullopt;
+        auto it = response.data.find("need");
+        if (it == response.data.end() || !it->is_array()) return std::nullopt;
+        std::vector<std::string> names;
+        for (const auto& name : *it) {
+            if (name.is_string()) names.push_back(name.get<std::string>());
+        }
+        return names;
+    }
+};
+
+// Дельта-передача файла: сигнатуры блоков новой версии файла (по block_size байт,
+// последний блок может быть короче). Сервер ищет блоки в том же файле версии base_hash
+// (см. ProgStart) по слабой скользящей сумме с проверкой сильной и отвечает
+// data.have - индексами блоков, которые у него уже есть. Остальные блоки клиент передаёт
+// чанками с полем block.
+struct BlockQuery : public Request {
+    struct Block {
+        uint32_t weak;      // utils::RollingChecksum
+        uint32_t strong;    // CRC32 блока
+    };
+
+    std::string        file_name;
+    uint64_t           file_size;
+    uint32_t           block_size;
+    std::vector<Block> blocks;
+
+    BlockQuery(std::string clientKey, std::string name, uint64_t size, uint32_t bsize,
+               std::vector<Block> b = {}):
+            Request(std::move(clientKey), "block_query"),
+            file_name(std::move(name)),
+            file_size(size),
+            block_size(bsize),
+            blocks(std::move(b)) {}
+
+    [[nodiscard]] std::string toJSON() const override {
+        json j;
+        j["key"]        = key;
+        j["request"]    = request;
+        j["file_name"]  = file_name;
+        j["file_size"]  = file_size;
+        j["block_size"] = block_size;
+        auto& list = j["blocks"] = json::array();
+        for (const auto& b : blocks) list.push_back({b.weak, b.strong});
+        putId(j);
+        return j.dump();
+    }
+
+    static BlockQuery fromJSON(const std::string& jsonStr) {
+        auto j = json::parse(jsonStr);
+        BlockQuery r{
+                j["key"].get<std::string>(),
+                j["file_name"].get<std::string>(),
+                j["file_size"].get<uint64_t>(),
+                j["block_size"].get<uint32_t>()
         };
+        for (const auto& b : j["blocks"]) {
+            r.blocks.push_back({b.at(0).get<uint32_t>(), b.at(1).get<uint32_t>()});
+        }
+        r.id = j.value("id", uint64_t{0});
+        return r;
+    }
+
+    // Индексы блоков из ответа сервера (data.have); некорректные индексы отбрасываются
+    [[nodiscard]] std::vector<uint64_t> have(const Response& response) const {
+        std::vector<uint64_t> result;
+        if (!response.data.is_object()) return result;
+        auto it = response.data.find("have");
+        if (it == response.data.end() || !it->is_array()) return result;
+        for (const auto& index : *it) {
+            if (index.is_number_unsigned() && index.get<uint64_t>() < blocks.size()) {
+                result.push_back(index.get<uint64_t>());
+            }
+        }
+        return result;
     }
 };
 
+// stream - идентификатор потока файла, когда чанки нескольких файлов передаются вперемешку
+// (0 - файлы передаются по одному). Тот же stream указывается в file_chunk и file_end.
+// block_size != 0 - файл передаётся дельтой: чанки содержат только недостающие блоки
+// (поле block), остальные сервер берёт из версии base_hash.
+// codecs - кодеки сжатия чанков, поддерживаемые клиентом, в порядке предпочтения; сервер
+// выбирает один и возвращает его имя в data.codec (нет поля - чанки не сжимаются).
 struct FileStart : public Request {
     std::string file_name;
     uint64_t    file_size;
+    uint32_t    stream = 0;
+    uint32_t    block_size = 0;
+    std::vector<std::string> codecs;
 
     FileStart(std::string clientKey, std::string name, uint64_t size):
             Request(std::move(clientKey), "file_start"),
@@ -332,48 +697,192 @@ struct FileStart : public Request {
         j["request"]    = request;
         j["file_name"]  = file_name;
         j["file_size"]  = file_size;
+        if (stream != 0) j["stream"] = stream;
+        if (block_size != 0) j["block_size"] = block_size;
+        if (!codecs.empty()) j["codecs"] = codecs;
+        putId(j);
         return j.dump();
     }
 
     static FileStart fromJSON(const std::string& jsonStr) {
         auto j = json::parse(jsonStr);
-        return FileStart{
+        FileStart r{
                 j["key"].get<std::string>(),
                 j["file_name"].get<std::string>(),
                 j["file_size"].get<uint64_t>()
         };
+        r.stream = j.value("stream", uint32_t{0});
+        r.block_size = j.value("block_size", uint32_t{0});
+        r.codecs = j.value("codecs", std::vector<std::string>{});
+        r.id = j.value("id", uint64_t{0});
+        return r;
+    }
+
+    // Кодек, выбранный сервером (пустая строка - без сжатия)
+    static std::string codec(const Response& response) {
+        if (!response.data.is_object()) return {};
+        auto it = response.data.find("codec");
+        return (it != response.data.end() && it->is_string()) ? it->get<std::string>() : std::string{};
     }
 };
 
+// Чанки файла нумеруются с 1 (seq) и могут отправляться окном, не дожидаясь ответов.
+// Ответ на чанк seq подтверждает получение всех чанков файла с номерами <= seq (кумулятивно),
+// поэтому сервер вправе отвечать не на каждый чанк.
+// Данные чанка передаются либо в base64 в поле chunk_data, либо (raw == true) отдельным
+// двоичным кадром сразу за JSON-заголовком: заголовок тогда содержит "chunk_payload": "frame".
+// codec - данные чанка сжаты этим кодеком (см. FileStart); chunk_size - размер до сжатия.
+// offset - смещение данных чанка в файле: сервер записывает чанк по нему, поэтому после
+// обрыва связи передачу можно продолжить с подтверждённого места (см. FileStatus).
 struct FileChunk : public Request {
+    static constexpr const char* RAW_PAYLOAD = "frame";
+
     std::string chunk_data;
     uint64_t    chunk_size;
-
-    FileChunk(std::string clientKey, std::string data, uint64_t size):
+    uint64_t    seq = 0;        // Порядковый номер чанка в файле (0 - не задан)
+    uint32_t    stream = 0;     // Поток файла (см. FileStart)
+    std::optional<uint64_t> block;  // Индекс блока при дельта-передаче
+    std::string codec;          // Кодек сжатия данных (пусто - без сжатия)
+    std::optional<uint64_t> offset; // Смещение данных в файле
+    bool        raw = false;    // Данные в следующем кадре, chunk_data пуст
+
+    FileChunk(std::string clientKey, std::string data, uint64_t size, uint64_t n = 0):
             Request(std::move(clientKey), "file_chunk"),
             chunk_data(std::move(data)),
-            chunk_size(size) {}
+            chunk_size(size),
+            seq(n) {}
+
+    // Заголовок чанка, данные которого идут следующим кадром
+    static FileChunk header(std::string clientKey, uint64_t size, uint64_t n = 0, uint32_t stream = 0) {
+        FileChunk r{std::move(clientKey), std::string{}, size, n};
+        r.stream = stream;
+        r.raw = true;
+        return r;
+    }
 
     [[nodiscard]] std::string toJSON() const override {
         json j;
         j["key"]        = key;
         j["request"]    = request;
-        j["chunk_data"] = chunk_data;
+        if (raw) j["chunk_payload"] = RAW_PAYLOAD;
+        else     j["chunk_data"] = chunk_data;
         j["chunk_size"] = chunk_size;
+        if (seq != 0) j["seq"] = seq;
+        if (stream != 0) j["stream"] = stream;
+        if (block) j["block"] = *block;
+        if (!codec.empty()) j["codec"] = codec;
+        if (offset) j["offset"] = *offset;
+        putId(j);
         return j.dump();
     }
 
     static FileChunk fromJSON(const std::string& jsonStr) {
         auto j = json::parse(jsonStr);
-        return FileChunk{
+        FileChunk r{
                 j["key"].get<std::string>(),
-                j["chunk_data"].get<std::string>(),
-                j["chunk_size"].get<uint64_t>()
+                j.value("chunk_data", std::string{}),
+                j["chunk_size"].get<uint64_t>(),
+                j.value("seq", uint64_t{0})
         };
+        r.stream = j.value("stream", uint32_t{0});
+        if (j.contains("block")) r.block = j["block"].get<uint64_t>();
+        r.codec = j.value("codec", std::string{});
+        if (j.contains("offset")) r.offset = j["offset"].get<uint64_t>();
+        r.raw = j.value("chunk_payload", std::string{}) == RAW_PAYLOAD;
+        r.id = j.value("id", uint64_t{0});
+        return r;
     }
 };
 
 using FileEnd = Request;
-using ProgEnd = Request;
+
+// Возможности, подтверждённые сервером в data ответа на connect. Клиент предлагает их
+// в запросе (pub_topic_frame, file_chunk_payload), но включает только после подтверждения:
+// сервер, не знающий о возможности, поле не возвращает, и клиент остаётся на прежнем формате.
+struct ConnectReply {
+    bool pub_topic_frame = false;   // Публикации с первым кадром SendValues::topicFrame()
+    bool raw_file_chunks = false;   // Данные чанков файла отдельным кадром (FileChunk::RAW_PAYLOAD)
+
+    static ConnectReply fromResponse(const Response& response) {
+        ConnectReply r;
+        if (!response.data.is_object()) return r;
+        auto topic = response.data.find("pub_topic_frame");
+        r.pub_topic_frame = topic != response.data.end() && topic->is_boolean() && topic->get<bool>();
+        auto payload = response.data.find("file_chunk_payload");
+        r.raw_file_chunks = payload != response.data.end() && payload->is_string() &&
+                            payload->get<std::string>() == FileChunk::RAW_PAYLOAD;
+        return r;
+    }
+};
+
+// Состояние передачи файла после переподключения: сервер отвечает data.offset - длиной
+// непрерывно записанного начала файла. Ошибка в ответе - сервер передачу файла не помнит.
+struct FileStatus : public Request {
+    std::string file_name;
+    uint64_t    file_size;
+    uint32_t    stream = 0;
+
+    FileStatus(std::string clientKey, std::string name, uint64_t size, uint32_t stream_id = 0):
+            Request(std::move(clientKey), "file_status"),
+            file_name(std::move(name)),
+            file_size(size),
+            stream(stream_id) {}
+
+    [[nodiscard]] std::string toJSON() const override {
+        json j;
+        j["key"]       = key;
+        j["request"]   = request;
+        j["file_name"] = file_name;
+        j["file_size"] = file_size;
+        if (stream != 0) j["stream"] = stream;
+        putId(j);
+        return j.dump();
+    }
+
+    static FileStatus fromJSON(const std::string& jsonStr) {
+        auto j = json::parse(jsonStr);
+        FileStatus r{
+                j["key"].get<std::string>(),
+                j["file_name"].get<std::string>(),
+                j["file_size"].get<uint64_t>(),
+                j.value("stream", uint32_t{0})
+        };
+        r.id = j.value("id", uint64_t{0});
+        return r;
+    }
+
+    // Подтверждённое смещение из ответа; nullopt - сервер его не сообщил
+    static std::optional<uint64_t> offset(const Response& response) {
+        if (!response.data.is_object()) return std::nullopt;
+        auto it = response.data.find("offset");
+        if (it == response.data.end() || !it->is_number_unsigned()) return std::nullopt;
+        return it->get<uint64_t>();
+    }
+};
+
+struct ProgEnd : public Request {
+    std::optional<uint64_t> prog_hash;  // Хеш программы, если prog_start был с prog_hash_trailer
+
+    explicit ProgEnd(std::string clientKey, std::optional<uint64_t> hash = std::nullopt):
+            Request(std::move(clientKey), "prog_end"),
+            prog_hash(hash) {}
+
+    [[nodiscard]] std::string toJSON() const override {
+        json j;
+        j["key"]     = key;
+        j["request"] = request;
+        if (prog_hash) j["prog_hash"] = *prog_hash;
+        putId(j);
+        return j.dump();
+    }
+
+    static ProgEnd fromJSON(const std::string& jsonStr) {
+        auto j = json::parse(jsonStr);
+        ProgEnd r{j["key"].get<std::string>()};
+        if (j.contains("prog_hash")) r.prog_hash = j["prog_hash"].get<uint64_t>();
+        r.id = j.value("id", uint64_t{0});
+        return r;
+    }
+};
 
 // ----------------------------------------------------------------------------
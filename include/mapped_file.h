@@ -0,0 +1,139 @@
+//-----------------------------------------------------------------------------
+// Copyright © 2016-2025 AMBITECS <info@ambi.biz>
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace utils
+{
+    // Файл, отображённый в память только для чтения.
+    // Данные читаются с диска по мере обращения к страницам и не копируются в буферы процесса,
+    // поэтому одно отображение используется и для расчёта CRC, и для нарезки на чанки.
+    // Разделяется через std::shared_ptr: кадры ZeroMQ, ссылающиеся на данные,
+    // удерживают отображение до окончания отправки.
+    //
+    // Файл не должен укорачиваться, пока отображён (например, пересборка программы во время
+    // загрузки): обращение к странице за новым концом файла завершает процесс сигналом SIGBUS,
+    // а не коротким чтением, как при ifstream. Перед длительным чтением проверяйте truncated();
+    // проверка сужает окно гонки, но не закрывает его. В Windows укоротить отображённый файл
+    // система не даёт.
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::filesystem::path& filepath) : path_(filepath) {
+#ifdef _WIN32
+            file_ = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file_ == INVALID_HANDLE_VALUE) {
+                throw std::runtime_error("Cannot open file: " + filepath.string());
+            }
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(file_, &size)) {
+                close();
+                throw std::runtime_error("Cannot get file size: " + filepath.string());
+            }
+            size_ = static_cast<size_t>(size.QuadPart);
+            if (size_ == 0) return;     // Пустой файл отобразить нельзя
+
+            mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping_) {
+                data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+            }
+            if (!data_) {
+                close();
+                throw std::runtime_error("Cannot map file: " + filepath.string());
+            }
+#else
+            fd_ = ::open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd_ < 0) {
+                throw std::runtime_error("Cannot open file: " + filepath.string());
+            }
+            struct stat st{};
+            if (::fstat(fd_, &st) != 0) {
+                close();
+                throw std::runtime_error("Cannot get file size: " + filepath.string());
+            }
+            size_ = static_cast<size_t>(st.st_size);
+            if (size_ == 0) return;     // Пустой файл отобразить нельзя
+
+            void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+            if (data == MAP_FAILED) {
+                close();
+                throw std::runtime_error("Cannot map file: " + filepath.string());
+            }
+            data_ = static_cast<const uint8_t*>(data);
+            // Файл читается последовательно: ядро может читать наперёд крупными блоками
+            ::madvise(data, size_, MADV_SEQUENTIAL);
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile() { close(); }
+
+        static std::shared_ptr<const MappedFile> open(const std::filesystem::path& filepath) {
+            return std::make_shared<const MappedFile>(filepath);
+        }
+
+        [[nodiscard]] const uint8_t* data() const { return data_; }
+        [[nodiscard]] size_t size() const { return size_; }
+        [[nodiscard]] bool empty() const { return size_ == 0; }
+        [[nodiscard]] const std::filesystem::path& path() const { return path_; }
+
+        // Файл стал короче отображения (или его размер не удалось узнать): читать данные нельзя
+        [[nodiscard]] bool truncated() const {
+#ifdef _WIN32
+            return false;
+#else
+            if (fd_ < 0) return false;
+            struct stat st{};
+            return ::fstat(fd_, &st) != 0 || static_cast<size_t>(st.st_size) < size_;
+#endif
+        }
+
+    private:
+        void close() {
+#ifdef _WIN32
+            if (data_) UnmapViewOfFile(data_);
+            if (mapping_) CloseHandle(mapping_);
+            if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+            mapping_ = nullptr;
+            file_ = INVALID_HANDLE_VALUE;
+#else
+            if (data_) ::munmap(const_cast<uint8_t*>(data_), size_);
+            if (fd_ >= 0) ::close(fd_);
+            fd_ = -1;
+#endif
+            data_ = nullptr;
+        }
+
+        std::filesystem::path path_;
+        const uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        HANDLE file_ = INVALID_HANDLE_VALUE;
+        HANDLE mapping_ = nullptr;
+#else
+        int fd_ = -1;
+#endif
+    };
+
+} // namespace utils
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Кодек сжатия данных чанков файла
+ *
+ * Каждый чанк сжимается независимо (дельта-передача и повтор отдельных чанков не зависят
+ * от соседних). Кодек согласуется в file_start: клиент перечисляет поддерживаемые кодеки,
+ * сервер выбирает один (data.codec в ответе) или ни одного.
+ */
+class Codec {
+public:
+    virtual ~Codec() = default;
+
+    // Имя кодека в протоколе
+    [[nodiscard]] virtual const char* name() const = 0;
+
+    // Размер буфера, достаточный для сжатия size байт в худшем случае
+    [[nodiscard]] virtual size_t max_compressed_size(size_t size) const = 0;
+
+    // Сжать src в dst (capacity >= max_compressed_size); возвращает размер результата
+    virtual size_t compress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) const = 0;
+
+    // Распаковать src в dst; возвращает размер результата, 0 - данные повреждены или не помещаются
+    virtual size_t decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) const = 0;
+};
+
+/**
+ * @brief Встроенный кодек в формате блока LZ4 ("lz4")
+ *
+ * Собственная реализация без внешних зависимостей: жадный поиск совпадений по хеш-таблице
+ * 4-байтовых префиксов. Сжатые данные совместимы с LZ4_decompress_safe, поэтому сервер
+ * может распаковывать их штатной библиотекой.
+ */
+class Lz4BlockCodec final : public Codec {
+    static constexpr size_t MIN_MATCH = 4;
+    static constexpr size_t LAST_LITERALS = 5;      // Последние байты блока - всегда литералы
+    static constexpr size_t MF_LIMIT = 12;          // Совпадение не начинается ближе к концу
+    static constexpr size_t MAX_OFFSET = 65535;
+    static constexpr unsigned HASH_BITS = 12;
+
+    static uint32_t read32(const uint8_t* p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static uint32_t hash(uint32_t sequence) {
+        return (sequence * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    static uint8_t* put_length(uint8_t* op, size_t length) {
+        for (; length >= 255; length -= 255) *op++ = 255;
+        *op++ = static_cast<uint8_t>(length);
+        return op;
+    }
+
+    static uint8_t* put_sequence(uint8_t* op, const uint8_t* literals, size_t literal_length,
+                                 size_t offset, size_t match_length) {
+        uint8_t* token = op++;
+        *token = static_cast<uint8_t>((literal_length >= 15 ? 15 : literal_length) << 4);
+        if (literal_length >= 15) op = put_length(op, literal_length - 15);
+        if (literal_length) {   // Пустой вход: literals может быть nullptr
+            std::memcpy(op, literals, literal_length);
+            op += literal_length;
+        }
+        if (match_length == 0) return op;   // Последняя последовательность - только литералы
+
+        *op++ = static_cast<uint8_t>(offset);
+        *op++ = static_cast<uint8_t>(offset >> 8);
+        const size_t extra = match_length - MIN_MATCH;
+        *token |= static_cast<uint8_t>(extra >= 15 ? 15 : extra);
+        if (extra >= 15) op = put_length(op, extra - 15);
+        return op;
+    }
+
+public:
+    [[nodiscard]] const char* name() const override { return "lz4"; }
+
+    [[nodiscard]] size_t max_compressed_size(size_t size) const override {
+        return size + size / 255 + 16;
+    }
+
+    size_t compress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) const override {
+        if (capacity < max_compressed_size(size)) return 0;
+        uint8_t* op = dst;
+        const uint8_t* anchor = src;
+
+        if (size >= MF_LIMIT + 1) {
+            uint32_t table[1u << HASH_BITS] = {};   // Позиция + 1 (0 - пусто)
+            const uint8_t* const match_limit = src + size - LAST_LITERALS;
+            const uint8_t* const search_limit = src + size - MF_LIMIT;
+            const uint8_t* ip = src;
+
+            while (ip < search_limit) {
+                const uint32_t sequence = read32(ip);
+                uint32_t& slot = table[hash(sequence)];
+                const uint8_t* ref = slot ? src + slot - 1 : nullptr;
+                slot = static_cast<uint32_t>(ip - src) + 1;
+
+                if (!ref || static_cast<size_t>(ip - ref) > MAX_OFFSET || read32(ref) != sequence) {
+                    ++ip;
+                    continue;
+                }
+
+                // Расширяем совпадение назад (в пределах литералов) и вперёд
+                while (ip > anchor && ref > src && ip[-1] == ref[-1]) { --ip; --ref; }
+                size_t match_length = MIN_MATCH;
+                while (ip + match_length < match_limit && ip[match_length] == ref[match_length]) {
+                    ++match_length;
+                }
+
+                op = put_sequence(op, anchor, static_cast<size_t>(ip - anchor),
+                                  static_cast<size_t>(ip - ref), match_length);
+                ip += match_length;
+                anchor = ip;
+            }
+        }
+
+        op = put_sequence(op, anchor, static_cast<size_t>(src + size - anchor), 0, 0);
+        return static_cast<size_t>(op - dst);
+    }
+
+    size_t decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) const override {
+        const uint8_t* ip = src;
+        const uint8_t* const iend = src + size;
+        uint8_t* op = dst;
+        uint8_t* const oend = dst + capacity;
+
+        auto read_length = [&](size_t length, bool& ok) {
+            if (length != 15) return length;
+            uint8_t b;
+            do {
+                if (ip >= iend) { ok = false; return length; }
+                b = *ip++;
+                length += b;
+            } while (b == 255);
+            return length;
+        };
+
+        while (ip < iend) {
+            bool ok = true;
+            const uint8_t token = *ip++;
+            const size_t literal_length = read_length(token >> 4, ok);
+            if (!ok || literal_length > static_cast<size_t>(iend - ip) ||
+                literal_length > static_cast<size_t>(oend - op)) return 0;
+            if (literal_length) {   // dst может быть nullptr при нулевой ёмкости
+                std::memcpy(op, ip, literal_length);
+                ip += literal_length;
+                op += literal_length;
+            }
+            if (ip == iend) break;          // Последняя последовательность
+
+            if (iend - ip < 2) return 0;
+            const size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+            ip += 2;
+            const size_t match_length = read_length(token & 0x0F, ok) + MIN_MATCH;
+            if (!ok || offset == 0 || offset > static_cast<size_t>(op - dst) ||
+                match_length > static_cast<size_t>(oend - op)) return 0;
+            const uint8_t* ref = op - offset;
+            if (offset >= match_length) {
+                std::memcpy(op, ref, match_length);
+            } else {
+                for (size_t i = 0; i < match_length; ++i) op[i] = ref[i];  // Перекрытие: повтор последних offset байт
+            }
+            op += match_length;
+        }
+        return static_cast<size_t>(op - dst);
+    }
+};
+
+/**
+ * @brief Набор доступных кодеков в порядке предпочтения
+ *
+ * По умолчанию содержит только встроенный "lz4"; внешние кодеки (например, zstd)
+ * подключаются через add() без изменения протокола.
+ */
+class CodecRegistry {
+    std::vector<std::unique_ptr<Codec>> codecs_;
+
+public:
+    CodecRegistry() {
+        add(std::make_unique<Lz4BlockCodec>());
+    }
+
+    // Добавить кодек; добавленный позже имеет более высокий приоритет
+    void add(std::unique_ptr<Codec> codec) {
+        codecs_.insert(codecs_.begin(), std::move(codec));
+    }
+
+    [[nodiscard]] const Codec* find(const std::string& name) const {
+        for (const auto& codec : codecs_) {
+            if (name == codec->name()) return codec.get();
+        }
+        return nullptr;
+    }
+
+    [[nodiscard]] std::vector<std::string> names() const {
+        std::vector<std::string> result;
+        for (const auto& codec : codecs_) result.emplace_back(codec->name());
+        return result;
+    }
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <thread>
+
+// Таблица соответствия "числовой идентификатор запроса -> ожидающий запрос".
+// Открытая адресация с линейным пробированием, ёмкость фиксирована и выделяется один раз.
+// Работает без мьютексов: состояние ячейки целиком определяется атомарным id
+// (EMPTY - свободна, BUSY - ячейку в данный момент заполняют или освобождают).
+// Запись ищет свободную ячейку только в окне MaxProbe от "домашней" позиции,
+// поэтому поиск просматривает то же окно целиком и обходится без надгробий.
+// Кроме id у записи есть произвольная метка (tag) для редкого поиска полным перебором.
+template <typename T, size_t Capacity = 1024, size_t MaxProbe = 64>
+class CorrelationTable {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert(MaxProbe > 0 && MaxProbe <= Capacity, "MaxProbe must be in [1, Capacity]");
+
+public:
+    static constexpr uint64_t EMPTY = 0;
+    static constexpr uint64_t BUSY  = UINT64_MAX;
+
+    CorrelationTable() = default;
+    CorrelationTable(const CorrelationTable&) = delete;
+    CorrelationTable& operator=(const CorrelationTable&) = delete;
+
+    // Идентификатор не может совпадать со служебными значениями EMPTY и BUSY
+    static constexpr bool is_valid_id(uint64_t id) { return id != EMPTY && id != BUSY; }
+
+    // Добавить запись. false - в окне пробирования нет свободной ячейки
+    bool insert(uint64_t id, uint64_t tag, T value) {
+        if (!is_valid_id(id)) return false;
+        for (size_t i = 0; i < MaxProbe; ++i) {
+            Slot& slot = slots_[(home(id) + i) & MASK];
+            uint64_t expected = EMPTY;
+            if (slot.id.compare_exchange_strong(expected, BUSY, std::memory_order_acquire)) {
+                slot.value = std::move(value);
+                slot.tag.store(tag, std::memory_order_relaxed);
+                slot.id.store(id, std::memory_order_release);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Извлечь запись (ровно один из конкурирующих вызовов получит значение)
+    std::optional<T> take(uint64_t id) {
+        if (!is_valid_id(id)) return std::nullopt;
+        for (size_t i = 0; i < MaxProbe; ++i) {
+            Slot& slot = slots_[(home(id) + i) & MASK];
+            uint64_t current = settled_id(slot);
+            if (current == id && claim(slot, current)) {
+                return release(slot);
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Извлечь любую запись с указанной меткой (перебор всей таблицы)
+    std::optional<T> take_by_tag(uint64_t tag) {
+        for (Slot& slot : slots_) {
+            uint64_t current = settled_id(slot);
+            if (!is_valid_id(current)) continue;
+            // Метка записана до публикации id; если CAS по тому же id удался,
+            // ячейка всё ещё содержит ту же запись (id не повторяются)
+            if (slot.tag.load(std::memory_order_relaxed) == tag && claim(slot, current)) {
+                return release(slot);
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Извлечь любую запись (для снятия всех ожидающих запросов при завершении работы)
+    std::optional<T> take_any() {
+        for (Slot& slot : slots_) {
+            uint64_t current = settled_id(slot);
+            if (is_valid_id(current) && claim(slot, current)) {
+                return release(slot);
+            }
+        }
+        return std::nullopt;
+    }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    // Ячейка занимает собственную кэш-линию, чтобы соседние запросы не мешали друг другу
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> id{EMPTY};
+        std::atomic<uint64_t> tag{0};
+        T value{};
+    };
+
+    static size_t home(uint64_t id) {
+        // Перемешивание (splitmix64), чтобы последовательные id и хеши распределялись равномерно
+        id ^= id >> 30; id *= 0xbf58476d1ce4e5b9ULL;
+        id ^= id >> 27; id *= 0x94d049bb133111ebULL;
+        id ^= id >> 31;
+        return static_cast<size_t>(id);
+    }
+
+    static bool claim(Slot& slot, uint64_t id) {
+        return slot.id.compare_exchange_strong(id, BUSY, std::memory_order_acquire);
+    }
+
+    static std::optional<T> release(Slot& slot) {
+        std::optional<T> value{std::move(slot.value)};
+        slot.value = T{};
+        slot.id.store(EMPTY, std::memory_order_release);
+        return value;
+    }
+
+    // Состояние BUSY кратковременно - дожидаемся его окончания, чтобы не пропустить запись
+    static uint64_t settled_id(const Slot& slot) {
+        uint64_t id = slot.id.load(std::memory_order_acquire);
+        while (id == BUSY) {
+            std::this_thread::yield();
+            id = slot.id.load(std::memory_order_acquire);
+        }
+        return id;
+    }
+
+    std::array<Slot, Capacity> slots_{};
+};
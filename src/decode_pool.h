@@ -0,0 +1,129 @@
+#pragma once
+
+#include "spsc_ring.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Пул потоков разбора входящих сообщений
+ *
+ * У каждого потока (полосы) своя очередь SpscRing, единственный писатель - поток ввода-вывода.
+ * Сообщения одной полосы обрабатываются строго по порядку, поэтому состояние, зависящее
+ * от порядка, закрепляется за одной полосой; порядок между полосами восстанавливает обработчик.
+ * Поток полосы забирает из очереди до batch_limit элементов и передаёт их обработчику пакетом.
+ * Если очередь полосы заполнена, писатель приостанавливает приём (см. pause()), а читатель,
+ * освободив место, вызывает on_space - писатель возобновляет приём без опроса по таймеру.
+ */
+template <typename Item>
+class DecodePool {
+public:
+    using Handler = std::function<void(size_t lane, Item* items, size_t count)>;
+
+    DecodePool() = default;
+    DecodePool(const DecodePool&) = delete;
+    DecodePool& operator=(const DecodePool&) = delete;
+
+    ~DecodePool() { stop(); }
+
+    void start(size_t threads, size_t queue_capacity, size_t batch_limit,
+               Handler handler, std::function<void()> on_space) {
+        handler_ = std::move(handler);
+        on_space_ = std::move(on_space);
+        batch_limit_ = batch_limit > 0 ? batch_limit : 1;
+        stopping_ = false;
+        for (size_t i = 0; i < threads; ++i) {
+            lanes_.push_back(std::make_unique<Lane>(queue_capacity));
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            lanes_[i]->thread = std::thread(&DecodePool::run, this, i);
+        }
+    }
+
+    // Оставшиеся в очередях элементы обрабатываются до выхода потоков
+    void stop() {
+        stopping_ = true;
+        for (auto& lane : lanes_) {
+            { std::lock_guard<std::mutex> lock(lane->mutex); }
+            lane->cv.notify_one();
+        }
+        for (auto& lane : lanes_) {
+            if (lane->thread.joinable()) lane->thread.join();
+        }
+        lanes_.clear();
+    }
+
+    [[nodiscard]] size_t lanes() const { return lanes_.size(); }
+
+    // Только поток ввода-вывода. false - очередь полосы заполнена, item не изменён
+    bool try_push(size_t lane, Item& item) {
+        Lane& l = *lanes_[lane];
+        if (!l.ring.try_push(item)) return false;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (l.sleeping.load(std::memory_order_relaxed)) {
+            { std::lock_guard<std::mutex> lock(l.mutex); }
+            l.cv.notify_one();
+        }
+        return true;
+    }
+
+    // Писатель приостановил приём: после неудачного try_push он должен выставить флаг
+    // и повторить попытку, иначе освобождение места может пройти незамеченным
+    void pause() {
+        paused_.store(true, std::memory_order_seq_cst);
+    }
+
+    void resume() {
+        paused_.store(false, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] bool paused() const { return paused_.load(std::memory_order_relaxed); }
+
+private:
+    struct Lane {
+        explicit Lane(size_t capacity) : ring(capacity) {}
+
+        SpscRing<Item> ring;
+        std::thread thread{};
+        std::mutex mutex{};
+        std::condition_variable cv{};
+        std::atomic<bool> sleeping{false};
+    };
+
+    void run(size_t index) {
+        Lane& lane = *lanes_[index];
+        std::vector<Item> batch(batch_limit_);
+        while (true) {
+            size_t count = 0;
+            while (count < batch_limit_ && lane.ring.try_pop(batch[count])) ++count;
+
+            if (count > 0) {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (paused_.load(std::memory_order_relaxed) && on_space_) on_space_();
+                handler_(index, batch.data(), count);
+                continue;
+            }
+
+            lane.sleeping.store(true, std::memory_order_seq_cst);
+            {
+                std::unique_lock<std::mutex> lock(lane.mutex);
+                lane.cv.wait(lock, [&] { return stopping_ || !lane.ring.empty(); });
+            }
+            lane.sleeping.store(false, std::memory_order_relaxed);
+            if (stopping_ && lane.ring.empty()) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<Lane>> lanes_{};
+    Handler handler_{};
+    std::function<void()> on_space_{};
+    size_t batch_limit_ = 64;
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> paused_{false};
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "codec.h"
+#include "crc_utils.h"
+#include "dto.h"
+#include "transfer_tracker.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Состояние передачи одного файла программы
+ *
+ * Файл нарезается на чанки по порядку; CRC32 считается по ходу нарезки.
+ * stream - идентификатор потока при чередовании чанков нескольких файлов (0 - файл передаётся один).
+ * В дельта-режиме (block_size != 0) отправляются только блоки из missing, по одному на чанк;
+ * CRC32 в этом режиме считается заранее, вместе с сигнатурами блоков.
+ */
+struct FileUpload {
+    std::shared_ptr<const utils::MappedFile> file;
+    std::string name;
+    uint32_t stream = 0;
+    std::shared_ptr<TransferTracker> tracker;
+
+    uint64_t offset = 0;        // Конец последнего отправленного чанка
+    uint64_t chunk_offset = 0;  // Начало последнего отправленного чанка
+    uint64_t seq = 0;           // Номер последнего отправленного чанка
+    uint64_t base_seq = 0;      // seq на момент продолжения передачи (см. rewind)
+    int      resumes = 0;       // Число продолжений после обрыва
+    bool     aborted = false;   // Передача прервана (окно не освободилось или сервер отклонил чанк)
+    bool     truncated = false; // Файл укорочен во время передачи: продолжать её нельзя
+    utils::Crc32 crc{};
+    uint64_t hashed = 0;        // Учтено в crc
+
+    uint32_t block_size = 0;            // Дельта-режим: размер блока
+    std::vector<uint64_t> missing{};    // Индексы блоков, которых нет на сервере
+    size_t   next_missing = 0;
+    uint64_t block = 0;                 // Блок последнего отправленного чанка
+
+    const Codec* codec = nullptr;       // Кодек, выбранный сервером (nullptr - без сжатия)
+
+    // file_name - имя файла для сервера (путь относительно корня программы); пустое - имя файла
+    FileUpload(std::shared_ptr<const utils::MappedFile> f, uint32_t stream_id,
+               std::shared_ptr<TransferTracker> t, std::string file_name = {})
+            : file(std::move(f)),
+              name(file_name.empty() ? file->path().filename().string() : std::move(file_name)),
+              stream(stream_id),
+              tracker(std::move(t)) {}
+
+    [[nodiscard]] uint64_t size() const { return file->size(); }
+
+    // Все чанки поставлены в очередь (или передача прервана)
+    [[nodiscard]] bool sent() const {
+        if (aborted) return true;
+        return block_size != 0 ? next_missing >= missing.size() : offset >= size();
+    }
+
+    /**
+     * @brief Сигнатуры блоков файла для BlockQuery (попутно считается CRC32 всего файла)
+     */
+    std::vector<BlockQuery::Block> signatures(uint32_t bsize) {
+        std::vector<BlockQuery::Block> blocks;
+        blocks.reserve(static_cast<size_t>((size() + bsize - 1) / bsize));
+        crc.reset();
+        for (uint64_t pos = 0; pos < size(); pos += bsize) {
+            const uint8_t* data = file->data() + pos;
+            const size_t length = static_cast<size_t>(std::min<uint64_t>(bsize, size() - pos));
+            crc.update(data, length);
+            blocks.push_back({utils::RollingChecksum(data, length).value(),
+                              utils::calculate_crc32(data, length)});
+        }
+        hashed = size();
+        return blocks;
+    }
+
+    // Перейти в дельта-режим: передавать только блоки, которых нет в have
+    void use_blocks(uint32_t bsize, size_t block_count, const std::vector<uint64_t>& have) {
+        std::vector<bool> present(block_count, false);
+        for (uint64_t index : have) present[index] = true;
+        block_size = bsize;
+        missing.clear();
+        for (uint64_t index = 0; index < block_count; ++index) {
+            if (!present[index]) missing.push_back(index);
+        }
+        next_missing = 0;
+    }
+
+    // Передавать файл целиком (сервер не подтвердил блоки базовой версии)
+    void use_whole_file() {
+        block_size = 0;
+        missing.clear();
+        next_missing = 0;
+        block = 0;
+    }
+
+    // Следующий чанк: данные учитываются в CRC, номер чанка увеличивается
+    const uint8_t* next_chunk(size_t max_size, size_t& length) {
+        if (block_size != 0) {
+            block = missing[next_missing++];
+            offset = block * block_size;
+            max_size = block_size;
+        }
+        length = static_cast<size_t>(std::min<uint64_t>(max_size, size() - offset));
+        const uint8_t* data = file->data() + offset;
+        chunk_offset = offset;
+        if (offset == hashed) {
+            crc.update(data, length);
+            hashed += length;
+        }
+        offset += length;
+        ++seq;
+        return data;
+    }
+
+    // CRC32 всего файла: непереданный остаток тоже учитывается, чтобы сервер увидел несовпадение
+    uint32_t finish_crc() {
+        if (hashed < size() && !truncated) {
+            crc.update(file->data() + hashed, size() - hashed);
+            hashed = size();
+        }
+        return crc.value();
+    }
+
+    /**
+     * @brief Продолжить передачу с подтверждённого сервером смещения
+     * @param committed Длина непрерывно записанного сервером начала файла
+     * @param t Новый учёт чанков (ответы на чанки до обрыва уже не придут)
+     *
+     * Номера чанков продолжают расти; уже учтённые в CRC данные повторно не хешируются.
+     * В дельта-режиме передача продолжается с первого недостающего блока, не записанного целиком.
+     */
+    void rewind(uint64_t committed, std::shared_ptr<TransferTracker> t) {
+        committed = std::min(committed, size());
+        tracker = std::move(t);
+        aborted = false;
+        base_seq = seq;
+        if (block_size != 0) {
+            next_missing = 0;
+            while (next_missing < missing.size() && (missing[next_missing] + 1) * block_size <= committed) {
+                ++next_missing;
+            }
+        } else {
+            offset = committed;
+        }
+    }
+
+    [[nodiscard]] bool complete() {
+        return !aborted && !tracker->failed() && (seq == base_seq || tracker->acked() == seq);
+    }
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "crc_utils.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+
+/**
+ * @brief Локальный кэш CRC32 файлов на диске
+ *
+ * Ключ - путь к файлу, запись действительна, пока у файла те же время изменения и размер.
+ * Позволяет не пересчитывать хеши неизменившихся файлов при повторной загрузке программы.
+ * Файл кэша - JSON {"<path>": [mtime, size, crc], ...}; читается при первом обращении,
+ * записывается save() только при наличии изменений. Потокобезопасен.
+ * Расположение по умолчанию - default_path().
+ */
+class HashCache {
+    struct Entry {
+        int64_t  mtime;
+        uint64_t size;
+        uint32_t crc;
+    };
+
+    std::filesystem::path path_;
+    std::mutex mutex_{};
+    std::unordered_map<std::string, Entry> entries_{};
+    bool loaded_ = false;
+    bool dirty_ = false;
+
+    void load() {
+        loaded_ = true;
+        std::ifstream in(path_);
+        if (!in) return;
+        try {
+            auto j = nlohmann::json::parse(in);
+            for (auto it = j.begin(); it != j.end(); ++it) {
+                const auto& v = it.value();
+                entries_[it.key()] = {v.at(0).get<int64_t>(), v.at(1).get<uint64_t>(), v.at(2).get<uint32_t>()};
+            }
+        } catch (const std::exception&) {
+            entries_.clear();   // Повреждённый кэш просто пересобирается
+        }
+    }
+
+    static bool stat(const std::filesystem::path& file, int64_t& mtime, uint64_t& size) {
+        std::error_code ec;
+        const auto time = std::filesystem::last_write_time(file, ec);
+        if (ec) return false;
+        size = std::filesystem::file_size(file, ec);
+        if (ec) return false;
+        mtime = static_cast<int64_t>(time.time_since_epoch().count());
+        return true;
+    }
+
+public:
+    explicit HashCache(std::filesystem::path path) : path_(std::move(path)) {}
+
+    /**
+     * @brief Файл кэша по умолчанию
+     *
+     * Переменная окружения ZMQ_CLIENT_HASH_CACHE, иначе каталог кэша пользователя:
+     * %LOCALAPPDATA%\zmq-client (Windows), $XDG_CACHE_HOME/zmq-client или ~/.cache/zmq-client;
+     * если ни один не задан - временный каталог системы. Не зависит от текущего каталога.
+     */
+    static std::filesystem::path default_path() {
+        const auto env = [](const char* name) -> std::filesystem::path {
+            const char* value = std::getenv(name);
+            return (value && *value) ? std::filesystem::path(value) : std::filesystem::path{};
+        };
+        if (auto path = env("ZMQ_CLIENT_HASH_CACHE"); !path.empty()) return path;
+
+        std::filesystem::path dir;
+#ifdef _WIN32
+        dir = env("LOCALAPPDATA");
+#else
+        dir = env("XDG_CACHE_HOME");
+        if (dir.empty() && !env("HOME").empty()) dir = env("HOME") / ".cache";
+#endif
+        if (dir.empty()) {
+            std::error_code ec;
+            dir = std::filesystem::temp_directory_path(ec);
+        }
+        return dir / "zmq-client" / "hashes.json";
+    }
+
+    // Сменить файл кэша: записи прежнего файла отбрасываются, новый читается при первом обращении
+    void set_path(std::filesystem::path path) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        path_ = std::move(path);
+        entries_.clear();
+        loaded_ = false;
+        dirty_ = false;
+    }
+
+    HashCache(const HashCache&) = delete;
+    HashCache& operator=(const HashCache&) = delete;
+
+    /**
+     * @brief CRC32 отображённого файла: из кэша, если файл не менялся, иначе расчёт и запоминание
+     */
+    uint32_t file_crc32(const utils::MappedFile& file) {
+        std::error_code ec;
+        auto absolute = std::filesystem::absolute(file.path(), ec);
+        const std::string key = (ec ? file.path() : absolute).lexically_normal().string();
+        int64_t mtime = 0;
+        uint64_t size = 0;
+        const bool known = stat(file.path(), mtime, size) && size == file.size();
+        if (known) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!loaded_) load();
+            auto it = entries_.find(key);
+            if (it != entries_.end() && it->second.mtime == mtime && it->second.size == size) {
+                return it->second.crc;
+            }
+        }
+
+        const uint32_t crc = utils::calculate_file_crc32(file);
+        if (known) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            entries_[key] = {mtime, size, crc};
+            dirty_ = true;
+        }
+        return crc;
+    }
+
+    // Записать кэш на диск (через временный файл, чтобы не оставить его недописанным)
+    bool save() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!dirty_) return true;
+
+        nlohmann::json j = nlohmann::json::object();
+        for (const auto& [key, entry] : entries_) {
+            j[key] = {entry.mtime, entry.size, entry.crc};
+        }
+
+        std::error_code ec;
+        if (path_.has_parent_path()) std::filesystem::create_directories(path_.parent_path(), ec);
+        auto tmp = path_;
+        tmp += ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            if (!(out << j.dump())) return false;
+        }
+        std::filesystem::rename(tmp, path_, ec);
+        if (ec) return false;
+        dirty_ = false;
+        return true;
+    }
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+// Ограничение числа одновременно выполняемых (неподтверждённых) запросов
+class InFlightWindow {
+    std::mutex mutex_{};
+    std::condition_variable cv_{};
+    size_t limit_;
+    size_t in_flight_ = 0;
+
+public:
+    explicit InFlightWindow(size_t limit) : limit_(limit > 0 ? limit : 1) {}
+
+    void set_limit(size_t limit) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            limit_ = limit > 0 ? limit : 1;
+        }
+        cv_.notify_all();
+    }
+
+    [[nodiscard]] size_t limit() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return limit_;
+    }
+
+    [[nodiscard]] size_t in_flight() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return in_flight_;
+    }
+
+    // Занять место в окне; false - окно не освободилось за отведённое время
+    bool acquire_for(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cv_.wait_for(lock, timeout, [this] { return in_flight_ < limit_; })) {
+            return false;
+        }
+        ++in_flight_;
+        return true;
+    }
+
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (in_flight_ > 0) --in_flight_;
+        }
+        cv_.notify_all();
+    }
+
+    // Дождаться завершения всех запросов окна
+    bool wait_idle(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, timeout, [this] { return in_flight_ == 0; });
+    }
+};
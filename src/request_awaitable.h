@@ -0,0 +1,95 @@
+#pragma once
+
+// Ожидание ответа на ADM-запрос через co_await (доступно при сборке в режиме C++20)
+#if defined(__cpp_impl_coroutine)
+
+#include "sync_request.h"
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <functional>
+
+// Исполнитель, на котором возобновляется сопрограмма (пустой - прямо в потоке listen_loop)
+using ResumeExecutor = std::function<void(std::function<void()>)>;
+
+/**
+ * @brief Awaitable для асинхронного запроса: результат co_await - Response
+ *
+ * Запрос отправляется при приостановке сопрограммы; ответ (или таймаут) возобновляет её
+ * из потока, завершившего запрос, либо через переданный исполнитель. Если ответ не получен,
+ * результатом будет Response::error с описанием причины. Если запрос не удалось зарегистрировать
+ * (Starter вернул пустой RequestHandle или выбросил исключение), обработчик завершения вызван
+ * не будет: сопрограмма продолжается сразу, с ошибкой или с исключением Starter соответственно.
+ */
+class RequestAwaitable {
+public:
+    // Запуск запроса с заданным обработчиком завершения. Пустой RequestHandle - запрос
+    // не зарегистрирован, и обработчик не будет вызван
+    using Starter = std::function<RequestHandle(SyncRequest::Callback)>;
+
+    RequestAwaitable(std::string key, std::string request, Starter start, ResumeExecutor executor = {})
+            : key_(std::move(key)),
+              request_(std::move(request)),
+              start_(std::move(start)),
+              executor_(std::move(executor)) {}
+
+    RequestAwaitable(const RequestAwaitable&) = delete;
+    RequestAwaitable& operator=(const RequestAwaitable&) = delete;
+
+    [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        handle_ = handle;
+        RequestHandle request;
+        try {
+            request = start_([this](bool ok, const Response& response) { complete(ok, &response); });
+        } catch (...) {
+            error_ = std::current_exception();
+        }
+        // Обработчик не зарегистрирован и не будет вызван - иначе сопрограмма не возобновится никогда
+        if (!request) complete(false, nullptr);
+        return state_.exchange(SUSPENDED, std::memory_order_acq_rel) != COMPLETED;
+    }
+
+    Response await_resume() {
+        if (error_) std::rethrow_exception(error_);
+        if (!ok_) return Response::error(key_, request_, "No response from server");
+        return std::move(response_);
+    }
+
+private:
+    enum : int { STARTING = 0, SUSPENDED = 1, COMPLETED = 2 };
+
+    void complete(bool ok, const Response* response) {
+        ok_ = ok;
+        if (ok) response_ = *response;
+        // Если await_suspend ещё не завершился, сопрограмма продолжит выполнение без приостановки
+        if (state_.exchange(COMPLETED, std::memory_order_acq_rel) == SUSPENDED) {
+            resume();
+        }
+    }
+
+    void resume() {
+        // После возобновления awaitable может быть уже разрушен - члены класса больше не трогаем
+        auto handle = handle_;
+        if (executor_) {
+            auto executor = std::move(executor_);
+            executor([handle] { handle.resume(); });
+        } else {
+            handle.resume();
+        }
+    }
+
+    std::string key_;
+    std::string request_;
+    Starter start_;
+    ResumeExecutor executor_;
+    std::coroutine_handle<> handle_{};
+    std::atomic<int> state_{STARTING};
+    bool ok_ = false;
+    Response response_{};
+    std::exception_ptr error_{};
+};
+
+#endif // __cpp_impl_coroutine
@@ -1,57 +1,162 @@
 #pragma once
 
 #include "sync_request.h"
+#include "correlation_table.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <string_view>
+#include <vector>
 
 class RequestManager {
-    std::mutex mutex_;
-    std::unordered_map<std::string, std::shared_ptr<SyncRequest>> requests_;
-    //std::vector<std::shared_ptr<SyncRequest>> pending_requests_;
+public:
+    static constexpr uint32_t POOL_CAPACITY = 1024;   // Ёмкость пула и таблицы запросов (ожидающих запросов)
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    // Пул объявлен раньше таблицы: дескрипторы, оставшиеся в таблице, возвращаются в ещё живой пул
+    RequestPool pool_{POOL_CAPACITY};
+    // Ожидающие запросы по идентификатору корреляции (без общего мьютекса и без строковых ключей)
+    CorrelationTable<RequestHandle, POOL_CAPACITY> requests_;
+    std::atomic<uint64_t> next_id_{1};
+
+    // Сроки асинхронных запросов (синхронные снимает сам ожидающий поток)
+    struct Deadline {
+        clock::time_point when;
+        uint64_t id;
+        bool operator>(const Deadline& other) const { return when > other.when; }
+    };
+    std::mutex deadlines_mutex_{};
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<>> deadlines_{};
+    std::vector<uint64_t> expired_{};   // Используется только потоком, вызывающим expire()
+    std::function<void()> on_earlier_deadline_{};
 
 public:
-    std::shared_ptr<SyncRequest> create(const std::string& key, const std::string& request) {
-        auto req = std::make_shared<SyncRequest>();
-        std::lock_guard<std::mutex> lock(mutex_);
-        requests_[key + ":" + request] = req;
+    RequestManager() = default;
+    RequestManager(const RequestManager&) = delete;
+    RequestManager& operator=(const RequestManager&) = delete;
+
+    ~RequestManager() { cancel_all(); }
+
+    // Маршрут запроса: FNV-1a от "key:request", вычисляется без построения строки.
+    // Нужен только для ответов серверов, которые не возвращают идентификатор корреляции
+    static uint64_t route_of(std::string_view key, std::string_view request) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        auto mix = [&hash](std::string_view s) {
+            for (unsigned char c : s) { hash = (hash ^ c) * 0x100000001b3ULL; }
+        };
+        mix(key);
+        mix(":");
+        mix(request);
+        return hash;
+    }
+
+    // Каждый запрос получает собственный монотонно растущий id,
+    // поэтому одинаковые запросы могут выполняться одновременно.
+    // Если таблица переполнена, запрос сразу завершается неудачей
+    RequestHandle create(const std::string& key, const std::string& request,
+                         SyncRequest::Callback callback = {}) {
+        auto req = pool_.acquire(next_id_.fetch_add(1, std::memory_order_relaxed), std::move(callback));
+        if (!requests_.insert(req->id(), route_of(key, request), req)) {
+            req->fail();
+        }
         return req;
     }
 
+    // Асинхронный запрос: по истечении timeout завершается неудачей из expire()
+    RequestHandle create_async(const std::string& key, const std::string& request,
+                               SyncRequest::Callback callback,
+                               std::chrono::milliseconds timeout) {
+        auto req = create(key, request, std::move(callback));
+        const auto when = clock::now() + timeout;
+        bool earliest;
+        try {
+            std::lock_guard<std::mutex> lock(deadlines_mutex_);
+            earliest = deadlines_.empty() || when < deadlines_.top().when;
+            deadlines_.push({when, req->id()});
+        } catch (...) {
+            // Без срока запрос не завершился бы никогда: снимаем его, не вызывая обработчик
+            // (вызывающий получит исключение вместо RequestHandle)
+            requests_.take(req->id());
+            throw;
+        }
+        if (earliest && on_earlier_deadline_) on_earlier_deadline_();
+        return req;
+    }
+
+    // Обработчик появления срока раньше всех прежних: поток, вызывающий expire(),
+    // спит до next_deadline() и должен пересчитать таймаут. Задаётся до начала работы
+    void on_earlier_deadline(std::function<void()> handler) {
+        on_earlier_deadline_ = std::move(handler);
+    }
+
+    // Ближайший срок асинхронного запроса (может относиться к уже завершённому запросу)
+    [[nodiscard]] std::optional<clock::time_point> next_deadline() {
+        std::lock_guard<std::mutex> lock(deadlines_mutex_);
+        if (deadlines_.empty()) return std::nullopt;
+        return deadlines_.top().when;
+    }
+
     bool process_response(const Response& response) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto key = response.key + ":" + response.request;
-        if (auto it = requests_.find(key); it != requests_.end()) {
-            it->second->set_response(response);
-            requests_.erase(it);
+        auto req = response.id != 0
+                   ? requests_.take(response.id)
+                   : requests_.take_by_tag(route_of(response.key, response.request));
+        if (req) {
+            (*req)->set_response(response);
             return true;
         }
         return false;
     }
 
-//    std::shared_ptr<SyncRequest> create(const std::string& client_key,
-//                                        const std::string& request_type) {
-//        auto req = std::make_shared<SyncRequest>();
-//        req->setup(client_key, request_type);
-//
-//        std::lock_guard<std::mutex> lock(mutex_);
-//        pending_requests_.push_back(req);
-//        return req;
-//    }
-//
-//    bool process_response(const Response& response) {
-//        std::lock_guard<std::mutex> lock(mutex_);
-//        for (auto it = pending_requests_.begin(); it != pending_requests_.end(); ) {
-//            if ((*it)->check_match(response)) {
-//                (*it)->notify(response);
-//                it = pending_requests_.erase(it);
-//                return true;
-//            } else {
-//                ++it;
-//            }
-//        }
-//        return false;
-//    }
-//
-//    void cleanup() {
-//        std::lock_guard<std::mutex> lock(mutex_);
-//        pending_requests_.clear();
-//    }
+    // Пакет ответов, принятых за одно пробуждение; ответы без ожидающего запроса
+    // передаются в unmatched(const Response&). Возвращает число сопоставленных
+    template <typename Unmatched>
+    size_t process_responses(const std::vector<Response>& responses, Unmatched&& unmatched) {
+        size_t matched = 0;
+        for (const auto& response : responses) {
+            if (process_response(response)) ++matched;
+            else unmatched(response);
+        }
+        return matched;
+    }
+
+    // Снять запрос, ответ на который так и не пришёл (иначе он навсегда займёт ячейку таблицы)
+    void cancel(const SyncRequest& request) {
+        if (auto req = requests_.take(request.id())) {
+            (*req)->fail();
+        }
+    }
+
+    // Завершить неудачей все ожидающие запросы (остановка клиента: expire() больше не вызывается).
+    // Обработчики вызываются сразу, поэтому владелец вызывает метод, пока их данные живы
+    void cancel_all() {
+        while (auto req = requests_.take_any()) {
+            (*req)->fail();
+        }
+        std::lock_guard<std::mutex> lock(deadlines_mutex_);
+        deadlines_ = {};
+    }
+
+    // Завершить просроченные асинхронные запросы
+    void expire(clock::time_point now = clock::now()) {
+        {
+            std::lock_guard<std::mutex> lock(deadlines_mutex_);
+            while (!deadlines_.empty() && deadlines_.top().when <= now) {
+                expired_.push_back(deadlines_.top().id);
+                deadlines_.pop();
+            }
+        }
+        // Обработчики вызываются вне блокировки: они могут создавать новые запросы
+        for (uint64_t id : expired_) {
+            if (auto req = requests_.take(id)) {
+                (*req)->fail();
+            }
+        }
+        expired_.clear();
+    }
 };
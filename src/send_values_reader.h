@@ -0,0 +1,230 @@
+#pragma once
+
+#include "dto.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Потоковый (SAX) разбор JSON-публикации SendValues без построения DOM
+ *
+ * Теги разбираются во внутренний буфер, минуя json-дерево и std::vector<Tag>, и передаются
+ * в приёмник только после успешного разбора всего сообщения: усечённое или некорректное
+ * сообщение не применяется даже частично.
+ * Приёмник: sink(const std::string& key, uint64_t value, Quality quality, sysclk::time_point timestamp).
+ * Публикации для другого клиента (поле "key") и без поля "key" отбрасываются; порядок полей
+ * значения не имеет. Тег без любого из полей key/value/quality/timestamp делает сообщение некорректным.
+ * Объект рассчитан на повторное использование: буферы сохраняют ёмкость между сообщениями.
+ */
+class SendValuesReader {
+public:
+    using number_integer_t  = json::number_integer_t;
+    using number_unsigned_t = json::number_unsigned_t;
+    using number_float_t    = json::number_float_t;
+    using string_t          = json::string_t;
+    using binary_t          = json::binary_t;
+
+    explicit SendValuesReader(std::string client_key) : client_key_(std::move(client_key)) {}
+
+    /**
+     * @brief Разобрать сообщение
+     * @return Число тегов, переданных в приёмник; -1 - сообщение некорректно (см. error())
+     */
+    template <typename Sink>
+    long read(const char* data, size_t size, Sink&& sink) {
+        reset();
+        const bool ok = json::sax_parse(data, data + size, this);
+        if (!ok && !key_mismatch_) return -1;
+        if (key_state_ != KeyState::Match) return 0;     // Чужая публикация или ключ так и не пришёл
+
+        for (size_t i = 0; i < pending_count_; ++i) {
+            const Pending& tag = pending_[i];
+            sink(tag.key, tag.value, tag.quality, tag.timestamp);
+        }
+        return static_cast<long>(pending_count_);
+    }
+
+    [[nodiscard]] const std::string& error() const { return error_; }
+
+    // --- Обработчики SAX (вызываются json::sax_parse) ---
+
+    bool null() { return true; }
+    bool boolean(bool) { return true; }
+
+    bool number_integer(number_integer_t val) {
+        return number(static_cast<int64_t>(val));
+    }
+
+    bool number_unsigned(number_unsigned_t val) {
+        if (in_tag() && field_ == Field::Value) { current_.value = val; seen_ |= SEEN_VALUE; return true; }
+        return number(static_cast<int64_t>(val));
+    }
+
+    bool number_float(number_float_t val, const string_t&) {
+        return number(static_cast<int64_t>(val));
+    }
+
+    bool string(string_t& val) {
+        if (level_ == 1 && field_ == Field::ClientKey) {
+            key_state_ = (val == client_key_) ? KeyState::Match : KeyState::Mismatch;
+            if (key_state_ == KeyState::Mismatch) {
+                key_mismatch_ = true;
+                return false;   // Чужая публикация - дальше не разбираем
+            }
+        } else if (in_tag() && field_ == Field::TagKey) {
+            current_.key.assign(val);
+            seen_ |= SEEN_KEY;
+        }
+        return true;
+    }
+
+    bool binary(binary_t&) { return true; }
+
+    bool start_object(std::size_t) {
+        ++level_;
+        if (in_tag()) {
+            current_.reset();
+            seen_ = 0;
+        }
+        field_ = Field::None;
+        return true;
+    }
+
+    bool end_object() {
+        if (in_tag()) {
+            if (seen_ != SEEN_ALL) {
+                error_ = "SendValues: incomplete tag object";
+                return false;
+            }
+            emit();
+        }
+        --level_;
+        field_ = Field::None;
+        return true;
+    }
+
+    // Вложенные массивы (в том числе внутри тегов) учитываются в уровне вложенности
+    // и не завершают массив "values"
+    bool start_array(std::size_t) {
+        ++level_;
+        if (level_ == 2 && field_ == Field::Values && values_level_ == 0) {
+            in_values_ = true;
+            values_level_ = level_;
+        }
+        field_ = Field::None;
+        return true;
+    }
+
+    bool end_array() {
+        if (in_values_ && level_ == values_level_) in_values_ = false;
+        --level_;
+        field_ = Field::None;
+        return true;
+    }
+
+    bool key(string_t& val) {
+        field_ = Field::None;
+        if (level_ == 1) {
+            if (val == "key") field_ = Field::ClientKey;
+            else if (val == "values") field_ = Field::Values;
+        } else if (in_tag()) {
+            if (val == "key") field_ = Field::TagKey;
+            else if (val == "value") field_ = Field::Value;
+            else if (val == "quality") field_ = Field::Quality;
+            else if (val == "timestamp") field_ = Field::Timestamp;
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) {
+        error_ = ex.what();
+        return false;
+    }
+
+private:
+    enum class Field { None, ClientKey, Values, TagKey, Value, Quality, Timestamp };
+    enum class KeyState { Unknown, Match, Mismatch };
+
+    struct Pending {
+        std::string         key;
+        uint64_t            value = 0;
+        Quality             quality = Quality::GOOD;
+        sysclk::time_point  timestamp{};
+
+        void reset() {
+            key.clear();
+            value = 0;
+            quality = Quality::GOOD;
+            timestamp = sysclk::time_point{};
+        }
+    };
+
+    // Поля тега, встреченные при разборе
+    static constexpr unsigned SEEN_KEY       = 1;
+    static constexpr unsigned SEEN_VALUE     = 2;
+    static constexpr unsigned SEEN_QUALITY   = 4;
+    static constexpr unsigned SEEN_TIMESTAMP = 8;
+    static constexpr unsigned SEEN_ALL       = SEEN_KEY | SEEN_VALUE | SEEN_QUALITY | SEEN_TIMESTAMP;
+
+    // Объект тега - непосредственный элемент массива "values"
+    [[nodiscard]] bool in_tag() const { return in_values_ && level_ == values_level_ + 1; }
+
+    bool number(int64_t val) {
+        if (!in_tag()) return true;
+        switch (field_) {
+            case Field::Value:
+                current_.value = static_cast<uint64_t>(val);
+                seen_ |= SEEN_VALUE;
+                break;
+            case Field::Quality:
+                current_.quality = fromInt(static_cast<int>(val));
+                seen_ |= SEEN_QUALITY;
+                break;
+            case Field::Timestamp:
+                current_.timestamp = sysclk::time_point(std::chrono::milliseconds(val));
+                seen_ |= SEEN_TIMESTAMP;
+                break;
+            default: break;
+        }
+        return true;
+    }
+
+    // Теги применяются только после разбора всего сообщения (буфер переиспользуется)
+    void emit() {
+        if (pending_count_ == pending_.size()) pending_.emplace_back();
+        Pending& slot = pending_[pending_count_++];
+        slot.key.assign(current_.key);
+        slot.value = current_.value;
+        slot.quality = current_.quality;
+        slot.timestamp = current_.timestamp;
+    }
+
+    void reset() {
+        level_ = 0;
+        values_level_ = 0;
+        in_values_ = false;
+        seen_ = 0;
+        field_ = Field::None;
+        key_state_ = KeyState::Unknown;
+        key_mismatch_ = false;
+        pending_count_ = 0;
+        error_.clear();
+    }
+
+    std::string client_key_;
+
+    int      level_ = 0;               // Вложенность объектов и массивов
+    int      values_level_ = 0;        // Уровень массива "values" (0 - ещё не встречен)
+    bool     in_values_ = false;
+    unsigned seen_ = 0;                // Поля текущего тега (SEEN_*)
+    Field    field_ = Field::None;
+    KeyState key_state_ = KeyState::Unknown;
+    bool     key_mismatch_ = false;
+
+    Pending              current_{};
+    std::vector<Pending> pending_{};
+    size_t               pending_count_ = 0;
+    std::string          error_{};
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Ограниченная очередь "один писатель - один читатель" без блокировок.
+// Ёмкость - степень двойки; элементы перемещаются в заранее созданные ячейки,
+// поэтому буферы элементов (например, zmq::message_t) переиспользуются без выделения памяти.
+template <typename T>
+class SpscRing {
+    static constexpr size_t CACHE_LINE = 64;
+
+    const size_t mask_;
+    std::unique_ptr<T[]> items_;
+
+    alignas(CACHE_LINE) std::atomic<size_t> head_{0};   // Следующий элемент для читателя
+    alignas(CACHE_LINE) std::atomic<size_t> tail_{0};   // Следующая ячейка для писателя
+
+    static size_t round_up(size_t capacity) {
+        size_t result = 2;
+        while (result < capacity) result <<= 1;
+        return result;
+    }
+
+public:
+    explicit SpscRing(size_t capacity)
+            : mask_(round_up(capacity) - 1), items_(new T[mask_ + 1]) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    [[nodiscard]] size_t capacity() const { return mask_ + 1; }
+
+    // Только писатель. false - очередь заполнена, item не изменён
+    bool try_push(T& item) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) > mask_) return false;
+        items_[tail & mask_] = std::move(item);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Только читатель. false - очередь пуста
+    bool try_pop(T& out) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) return false;
+        out = std::move(items_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+};
@@ -1,68 +1,216 @@
 #pragma once
 
 #include "dto.h"
-#include <mutex>
-#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
 
-class SyncRequest {
-    std::mutex mutex_{};
-    std::condition_variable cv_{};
+#if defined(__linux__)
+    #include <climits>
+    #include <ctime>
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#else
+    #include <mutex>
+    #include <condition_variable>
+#endif
 
-//    bool response_received_ = false;
-//    std::string expected_key_{};
-//    std::string expected_request_{};
-
-    Response response_ = Response::success("key", "action");
-    bool ready_ = false;
+class RequestPool;
 
+// Ожидающий запрос. Объекты берутся из предвыделенного пула RequestPool и переиспользуются,
+// поэтому в установившемся режиме создание запроса не выделяет память.
+// Ожидание построено на атомарном состоянии (futex в Linux)
+class SyncRequest {
 public:
+    // Обработчик завершения запроса: ok == false - ответ не получен (таймаут, ошибка отправки).
+    // Вызывается из потока, завершившего запрос (обычно listen_loop), поэтому не должен блокироваться
+    using Callback = std::function<void(bool ok, const Response& response)>;
+
     SyncRequest() = default;
+    SyncRequest(const SyncRequest&) = delete;
+    SyncRequest& operator=(const SyncRequest&) = delete;
+
+    [[nodiscard]] uint64_t id() const { return id_; }
 
+    // Завершить запрос ответом. Ответ копируется в строки, оставшиеся от прошлого
+    // использования объекта, - обычно без выделения памяти
     void set_response(const Response& response) {
-        std::lock_guard<std::mutex> lock(mutex_);
         response_ = response;
-        ready_ = true;
-        cv_.notify_one();
+        complete(OK);
+        if (callback_) callback_(true, response_);
+    }
+
+    // Завершить запрос без ответа
+    void fail() {
+        complete(FAILED);
+        if (callback_) callback_(false, response_);
+    }
+
+    [[nodiscard]] bool ready() const {
+        return state_.load(std::memory_order_acquire) != PENDING;
     }
 
     bool wait(Response& out, std::chrono::milliseconds timeout) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        uint32_t state;
+        while ((state = state_.load(std::memory_order_acquire)) == PENDING) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) return false;
+            block(deadline - now);
+        }
+        if (state != OK) return false;
+        out = response_;
+        return true;
+    }
+
+private:
+    friend class RequestPool;
+    friend class RequestHandle;
+
+    enum : uint32_t { PENDING = 0, OK = 1, FAILED = 2 };
+
+    void complete(uint32_t state) {
+#if defined(__linux__)
+        state_.store(state, std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_seq_cst) > 0) {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&state_), FUTEX_WAKE_PRIVATE, INT_MAX,
+                    nullptr, nullptr, 0);
+        }
+#else
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            state_.store(state, std::memory_order_release);
+        }
+        cv_.notify_all();
+#endif
+    }
+
+    void block(std::chrono::steady_clock::duration timeout) {
+#if defined(__linux__)
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count();
+        timespec ts{static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000)};
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&state_), FUTEX_WAIT_PRIVATE, PENDING,
+                &ts, nullptr, 0);
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+#else
         std::unique_lock<std::mutex> lock(mutex_);
-        return cv_.wait_for(lock, timeout, [this] { return ready_; })
-               && (out = response_, true);
+        cv_.wait_for(lock, timeout, [this] { return state_.load(std::memory_order_acquire) != PENDING; });
+#endif
     }
 
+    void release();   // Определена после RequestPool
+
+    std::atomic<uint32_t> state_{PENDING};
+    std::atomic<uint32_t> refs_{0};
+#if defined(__linux__)
+    std::atomic<uint32_t> waiters_{0};
+#else
+    std::mutex mutex_{};
+    std::condition_variable cv_{};
+#endif
+    uint64_t id_ = 0;
+    Response response_ = Response::success("key", "action");
+    Callback callback_{};
 
-//    void setup(const std::string& client_key, const std::string& request_type) {
-//        std::lock_guard<std::mutex> lock(mutex_);
-//        expected_key_ = client_key;
-//        expected_request_ = request_type;
-//        response_received_ = false;
-//    }
-
-//    bool check_match(const Response& response) const {
-//        return response.key == expected_key_ &&
-//               response.request == expected_request_;
-//    }
-
-//    void notify(const Response& response) {
-//        std::lock_guard<std::mutex> lock(mutex_);
-//        response_ = response;
-//        response_received_ = true;
-//        cv_.notify_one();
-//    }
-
-//    bool wait(Response& out_response, std::chrono::milliseconds timeout) {
-//        std::unique_lock<std::mutex> lock(mutex_);
-//        auto start = std::chrono::steady_clock::now();
-//
-//        bool result = cv_.wait_for(lock, timeout, [this]() {
-//            return response_received_;
-//        });
-//
-//        if (result) {
-//            out_response = response_;
-//        }
-//
-//        return result;
-//    }
-};
\ No newline at end of file
+    RequestPool* pool_ = nullptr;           // nullptr - объект создан сверх ёмкости пула
+    std::atomic<uint32_t> next_free_{0};    // Связь в списке свободных объектов пула
+};
+
+// Разделяемая ссылка на запрос из пула (аналог shared_ptr со встроенным счётчиком)
+class RequestHandle {
+    SyncRequest* request_ = nullptr;
+
+public:
+    RequestHandle() = default;
+    explicit RequestHandle(SyncRequest* request) : request_(request) {
+        if (request_) request_->refs_.fetch_add(1, std::memory_order_relaxed);
+    }
+    RequestHandle(const RequestHandle& other) : RequestHandle(other.request_) {}
+    RequestHandle(RequestHandle&& other) noexcept : request_(other.request_) { other.request_ = nullptr; }
+    RequestHandle& operator=(RequestHandle other) noexcept {
+        std::swap(request_, other.request_);
+        return *this;
+    }
+    ~RequestHandle() {
+        if (request_ && request_->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            request_->release();
+        }
+    }
+
+    SyncRequest* operator->() const { return request_; }
+    SyncRequest& operator*() const { return *request_; }
+    explicit operator bool() const { return request_ != nullptr; }
+};
+
+// Предвыделенный пул запросов: свободные объекты хранятся в lock-free стеке.
+// Если пул исчерпан, запрос создаётся в куче и удаляется после использования
+class RequestPool {
+public:
+    explicit RequestPool(uint32_t capacity)
+            : capacity_(capacity),
+              slots_(std::make_unique<SyncRequest[]>(capacity)) {
+        for (uint32_t i = 0; i < capacity_; ++i) {
+            slots_[i].pool_ = this;
+            slots_[i].next_free_.store(i + 1 < capacity_ ? i + 2 : 0, std::memory_order_relaxed);
+        }
+        head_.store(capacity_ > 0 ? 1 : 0, std::memory_order_relaxed);
+    }
+
+    RequestPool(const RequestPool&) = delete;
+    RequestPool& operator=(const RequestPool&) = delete;
+
+    RequestHandle acquire(uint64_t id, SyncRequest::Callback callback) {
+        SyncRequest* request = pop();
+        if (!request) request = new SyncRequest();
+        request->id_ = id;
+        request->callback_ = std::move(callback);
+        request->state_.store(SyncRequest::PENDING, std::memory_order_relaxed);
+        return RequestHandle(request);
+    }
+
+private:
+    friend class SyncRequest;
+
+    // Голова стека: старшие 32 бита - счётчик против ABA, младшие - индекс + 1 (0 - стек пуст)
+    SyncRequest* pop() {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        while (true) {
+            const auto index = static_cast<uint32_t>(head);
+            if (index == 0) return nullptr;
+            SyncRequest& slot = slots_[index - 1];
+            const uint64_t next = ((head >> 32) + 1) << 32 | slot.next_free_.load(std::memory_order_relaxed);
+            if (head_.compare_exchange_weak(head, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return &slot;
+            }
+        }
+    }
+
+    void push(SyncRequest* request) {
+        const auto index = static_cast<uint32_t>(request - slots_.get()) + 1;
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        while (true) {
+            request->next_free_.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            const uint64_t next = ((head >> 32) + 1) << 32 | index;
+            if (head_.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+    uint32_t capacity_;
+    std::unique_ptr<SyncRequest[]> slots_;
+    std::atomic<uint64_t> head_{0};
+};
+
+inline void SyncRequest::release() {
+    callback_ = nullptr;    // Освобождаем захваченные обработчиком ресурсы
+    if (pool_) {
+        pool_->push(this);
+    } else {
+        delete this;
+    }
+}
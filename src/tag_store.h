@@ -0,0 +1,189 @@
+#pragma once
+
+#include "dto.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Хранилище последних значений тегов
+ *
+ * Индекс "имя -> номер ячейки" плюс ячейки значений, сгруппированные в блоки фиксированного
+ * размера: обновление тега - O(1), новые теги добавляются в конец, блоки никогда не перемещаются.
+ * Каждая ячейка защищена собственным seqlock: читатели не берут блокировок и не мешают записи,
+ * а при совпадении с записью просто перечитывают ячейку. Индекс по имени блокируется
+ * (shared_mutex) только при добавлении нового тега.
+ * Пакеты, разобранные параллельно, могут применяться не в порядке приёма: значение с номером
+ * сообщения (order) не затирает значение из более позднего сообщения.
+ */
+class TagStore {
+    static constexpr size_t CHUNK_SIZE = 1024;      // Ячеек в блоке
+    static constexpr size_t MAX_CHUNKS = 1024;      // Максимум тегов: CHUNK_SIZE * MAX_CHUNKS
+
+    struct Slot {
+        std::atomic<uint32_t> seq{0};               // Нечётное значение - идёт запись
+        std::atomic<uint64_t> value{0};
+        std::atomic<int>      quality{static_cast<int>(Quality::GOOD)};
+        std::atomic<int64_t>  timestamp{0};         // sysclk::duration::rep
+        std::string           key{};                // Неизменно после публикации ячейки
+        uint64_t              order{0};             // Номер сообщения последней записи (под write_mutex_)
+    };
+
+    struct Chunk {
+        std::array<Slot, CHUNK_SIZE> slots{};
+    };
+
+    std::mutex write_mutex_{};                      // Упорядочивает писателей между собой
+    mutable std::shared_mutex index_mutex_{};       // Только для вставки нового имени
+    std::unordered_map<std::string, uint32_t> index_{};
+
+    std::array<std::atomic<Chunk*>, MAX_CHUNKS> chunks_{};
+    std::atomic<uint32_t> count_{0};                // Число опубликованных ячеек
+    std::atomic<uint64_t> version_{0};              // Растёт при каждом пакете изменений
+
+    Slot& slot(uint32_t index) const {
+        return chunks_[index / CHUNK_SIZE].load(std::memory_order_acquire)->slots[index % CHUNK_SIZE];
+    }
+
+    static void write_slot(Slot& s, uint64_t value, Quality quality, sysclk::time_point timestamp) {
+        const uint32_t seq = s.seq.load(std::memory_order_relaxed);
+        s.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        s.value.store(value, std::memory_order_relaxed);
+        s.quality.store(static_cast<int>(quality), std::memory_order_relaxed);
+        s.timestamp.store(timestamp.time_since_epoch().count(), std::memory_order_relaxed);
+        s.seq.store(seq + 2, std::memory_order_release);
+    }
+
+    static void read_slot(const Slot& s, Tag& out) {
+        uint64_t value;
+        int quality;
+        int64_t timestamp;
+        while (true) {
+            const uint32_t before = s.seq.load(std::memory_order_acquire);
+            if (before & 1u) { std::this_thread::yield(); continue; }
+            value = s.value.load(std::memory_order_relaxed);
+            quality = s.quality.load(std::memory_order_relaxed);
+            timestamp = s.timestamp.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.seq.load(std::memory_order_relaxed) == before) break;
+        }
+        out.value = value;
+        out.quality = static_cast<Quality>(quality);
+        out.timestamp = sysclk::time_point(sysclk::duration(timestamp));
+    }
+
+    // Вызывается только под write_mutex_: индекс читается писателем без блокировки,
+    // так как изменяет его только он сам
+    void set(const std::string& key, uint64_t value, Quality quality, sysclk::time_point timestamp,
+             uint64_t order) {
+        if (auto it = index_.find(key); it != index_.end()) {
+            Slot& s = slot(it->second);
+            if (order != 0) {
+                if (order < s.order) return;    // Уже записано значение из более позднего сообщения
+                s.order = order;
+            }
+            write_slot(s, value, quality, timestamp);
+            return;
+        }
+
+        const uint32_t index = count_.load(std::memory_order_relaxed);
+        if (index >= CHUNK_SIZE * MAX_CHUNKS) throw std::length_error("TagStore: too many tags");
+        auto& chunk = chunks_[index / CHUNK_SIZE];
+        if (!chunk.load(std::memory_order_relaxed)) {
+            chunk.store(new Chunk(), std::memory_order_release);
+        }
+
+        Slot& s = slot(index);
+        s.key = key;
+        s.order = order;
+        write_slot(s, value, quality, timestamp);
+        {
+            std::unique_lock<std::shared_mutex> lock(index_mutex_);
+            index_.emplace(key, index);
+        }
+        count_.store(index + 1, std::memory_order_release);
+    }
+
+public:
+    TagStore() = default;
+    TagStore(const TagStore&) = delete;
+    TagStore& operator=(const TagStore&) = delete;
+
+    ~TagStore() {
+        for (auto& chunk : chunks_) delete chunk.load(std::memory_order_relaxed);
+    }
+
+    // Пакет изменений: писатели упорядочены на время жизни объекта, читатели не блокируются
+    class Batch {
+        TagStore& store_;
+        std::lock_guard<std::mutex> lock_;
+
+    public:
+        explicit Batch(TagStore& store) : store_(store), lock_(store.write_mutex_) {}
+        ~Batch() { store_.version_.fetch_add(1, std::memory_order_release); }
+
+        // order - номер сообщения-источника (растёт в порядке приёма); 0 - записать безусловно
+        void set(const std::string& key, uint64_t value, Quality quality, sysclk::time_point timestamp,
+                 uint64_t order = 0) {
+            store_.set(key, value, quality, timestamp, order);
+        }
+    };
+
+    Batch batch() { return Batch(*this); }
+
+    [[nodiscard]] size_t size() const {
+        return count_.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] uint64_t version() const {
+        return version_.load(std::memory_order_acquire);
+    }
+
+    // Значение одного тега; false - тег ещё не получен
+    bool get(const std::string& key, Tag& out) const {
+        uint32_t index;
+        {
+            std::shared_lock<std::shared_mutex> lock(index_mutex_);
+            auto it = index_.find(key);
+            if (it == index_.end()) return false;
+            index = it->second;
+        }
+        const Slot& s = slot(index);
+        out.key = s.key;
+        read_slot(s, out);
+        return true;
+    }
+
+    /**
+     * @brief Снимок всех тегов в буфер out (строки буфера переиспользуются)
+     * @return Версия хранилища, не более поздняя, чем данные снимка
+     */
+    uint64_t snapshot(std::vector<Tag>& out) const {
+        const uint64_t version = version_.load(std::memory_order_acquire);
+        const uint32_t count = count_.load(std::memory_order_acquire);
+        out.resize(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            const Slot& s = slot(i);
+            Tag& tag = out[i];
+            if (tag.key != s.key) tag.key = s.key;
+            read_slot(s, tag);
+        }
+        return version;
+    }
+
+    [[nodiscard]] std::vector<Tag> snapshot() const {
+        std::vector<Tag> out;
+        snapshot(out);
+        return out;
+    }
+};
@@ -1,4 +1,15 @@
 #include "request_manager.h"
+#include "inflight_window.h"
+#include "request_awaitable.h"
+#include "send_values_reader.h"
+#include "tag_store.h"
+#include "transfer_tracker.h"
+#include "file_upload.h"
+#include "thread_pool.h"
+#include "hash_cache.h"
+#include "codec.h"
+#include "wakeup_channel.h"
+#include "decode_pool.h"
 
 #include <iostream>
 #include <zmq.hpp>
@@ -12,8 +23,17 @@
 #include <filesystem>
 #include <limits>
 #include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <set>
+#include <deque>
 #include "crc_utils.h"
 
+// zmq_poller доступен только в сборке libzmq с draft API; иначе - zmq_poll
+#if defined(ZMQ_BUILD_DRAFT_API) && defined(ZMQ_CPP11) && defined(ZMQ_HAVE_POLLER)
+    #define ZMQ_CLIENT_USE_POLLER 1
+#endif
+
 namespace fs = std::filesystem;
 using json = nlohmann::json;
 using namespace std::chrono_literals;
@@ -181,9 +201,12 @@ bool wait_for_input(std::chrono::milliseconds timeout) {
  * @brief ZMQ клиент для тестирования взаимодействия с сервером ProContEx
  */
 class TestClient {
+    friend struct TestClientAccess;           // Сетевые тесты (tests/client_access.h)
+
     zmq::context_t ctx_;                      // ZMQ контекст
     zmq::socket_t adm_socket_;                // Сокет для административных команд
     zmq::socket_t sub_socket_;                // Сокет для подписки на данные
+    WakeupChannel wakeup_;                    // Пробуждение listen_loop (остановка, сокеты, подписки, сроки, отправка)
     std::string client_id_;                   // Идентификатор клиента
     std::string server_host_;                 // Адрес сервера
     std::thread listen_thread_;               // Поток для прослушивания сообщений
@@ -191,16 +214,68 @@ class TestClient {
     std::thread connection_monitor_thread_;   // Поток мониторинга соединения
 
     std::atomic<bool> sockets_ready_{false};  // Флаг готовности сокетов
+    std::atomic<uint32_t> sockets_generation_{0}; // Растёт при замене или закрытии сокетов
+    std::mutex poll_mutex_;                   // Для ожидания polled_generation_
+    std::condition_variable sockets_detached_;
+    uint32_t polled_generation_{0};           // Поколение сокетов в опросе listen_loop
     std::atomic<bool> running_{false};        // Флаг работы клиента
     std::atomic<bool> connection_ok_{false};  // Флаг состояния соединения
 
     std::atomic<bool> start_complete{false}; // Флаг попытки переподключения
     std::atomic<bool> heartbeat_active_{false}; // Флаг активности heartbeat
 
-    bool debug_mode_{false};                   // Режим отладки
+    std::atomic<bool> debug_mode_{false};      // Режим отладки (меняется из меню, читается всеми потоками)
 
-    std::mutex updates_mutex_;               // Мьютекс для доступа к обновлениям
-    std::vector<Tag> last_updates_;          // Последние полученные обновления тегов
+    TagStore tag_store_;                     // Последние полученные значения тегов
+
+    bool binary_pub_{true};                  // Запрашивать у сервера двоичный формат публикаций
+    bool raw_file_chunks_{true};             // Предлагать серверу данные чанков отдельным кадром, без base64
+    std::atomic<bool> raw_chunks_active_{false}; // Отдельный кадр подтверждён в ответе на connect
+    std::atomic<uint32_t> pub_session_{0};   // Номер сеанса подписки (растёт при каждом connect)
+
+    // Разбор публикаций: listen_loop только принимает кадры, разбирают их потоки pub_pool_
+    // (при pub_decode_threads_ == 0 - сам listen_loop)
+    struct PubFrame {
+        zmq::message_t msg;
+        uint64_t order = 0;                  // Номер публикации в порядке приёма
+        uint32_t session = 0;                // pub_session_ на момент приёма
+    };
+    struct PubUpdate {                       // Разобранный тег до применения к tag_store_
+        std::string key;
+        uint64_t value = 0;
+        Quality quality = Quality::GOOD;
+        sysclk::time_point timestamp{};
+        uint64_t order = 0;
+    };
+    struct PubDecoder {                      // Состояние разбора одного потока
+        explicit PubDecoder(const std::string& client_id) : reader(client_id) {}
+        SendValuesReader reader;             // Потоковый разбор JSON-публикаций
+        TagDictionary dictionary;            // Имена тегов двоичного формата (только поток 0)
+        uint32_t dictionary_session = 0;     // Сеанс, к которому относится dictionary
+        std::vector<PubUpdate> updates;      // Пакет разобранных тегов (строки переиспользуются)
+        size_t update_count = 0;
+    };
+    size_t pub_decode_threads_{2};           // Потоков разбора публикаций (0 - разбор в listen_loop)
+    size_t pub_queue_capacity_{4096};        // Кадров в очереди каждого потока разбора
+    std::vector<std::unique_ptr<PubDecoder>> pub_decoders_; // По одному на поток (минимум один)
+    DecodePool<PubFrame> pub_pool_;
+    PubFrame pending_pub_{};                 // Принятый кадр, ожидающий места в очереди (только listen_loop)
+    bool has_pending_pub_{false};
+    uint64_t pub_order_{0};                  // Только listen_loop
+    size_t next_pub_lane_{0};                // Только listen_loop
+    size_t recv_batch_budget_{256};          // Сообщений, вычитываемых из сокета за одно пробуждение
+    static constexpr size_t ADM_CHECK_INTERVAL = 16; // Публикаций между проверками adm_socket_
+    std::vector<Response> adm_batch_;        // Пакет ответов ADM (только listen_loop)
+
+    // Подписки sub_socket_: меняются из любого потока, применяются в listen_loop,
+    // которому принадлежит сокет
+    bool pub_topic_filter_{true};            // Предлагать серверу кадр топика (фильтрация в libzmq)
+    std::mutex topics_mutex_;
+    bool pub_topic_frame_{false};            // Кадр топика подтверждён сервером в ответе на connect
+                                             // (под topics_mutex_); до этого - подписка на всё
+    std::set<std::string> pub_topics_;       // Текущие префиксы подписки
+    std::vector<std::pair<bool, std::string>> topic_changes_; // Ожидающие изменения (true - подписка)
+    std::atomic<bool> topics_dirty_{false};
 
     // Для синхронизации heartbeat
     std::condition_variable heartbeat_received_{};
@@ -213,7 +288,31 @@ class TestClient {
 
     RequestManager request_manager_{};
 
-    std::mutex send_mutex_{};
+    std::mutex send_mutex_{};           // Сокеты сеанса (замена и закрытие) и очередь outgoing_
+
+    // Исходящие ADM-сообщения. Сокет ZeroMQ не потокобезопасен, поэтому adm_socket_ использует
+    // только listen_loop: остальные потоки ставят сообщения в очередь и будят цикл через wakeup_
+    struct OutgoingMessage {
+        zmq::message_t header;
+        zmq::message_t payload;             // Второй кадр (двоичные данные чанка)
+        bool has_payload = false;
+    };
+    std::deque<OutgoingMessage> outgoing_{};    // Под send_mutex_
+    std::atomic<bool> outgoing_pending_{false}; // Очередь не пуста
+
+    InFlightWindow async_window_{256};  // Окно конвейерных (асинхронных) запросов
+    size_t transfer_window_{16};        // Чанков файла в пути без подтверждения
+    bool prog_hash_trailer_{true};      // Хеш программы в prog_end (считается при отправке)
+    size_t upload_streams_{4};          // Файлов программы, передаваемых одновременно (1 - по одному)
+    uint32_t delta_block_size_{8 * 1024}; // Блок дельта-загрузки (0 - файлы всегда целиком)
+    std::unordered_map<std::string, uint64_t> deployed_programs_; // Загруженные программы: имя -> хеш
+    bool prog_manifest_{true};          // Манифест файлов в prog_start, сервер отвечает списком need
+    HashCache hash_cache_{HashCache::default_path()}; // CRC32 неизменившихся файлов между запусками
+    bool compress_files_{true};         // Предлагать серверу сжатие чанков файлов
+    int max_resume_attempts_{3};        // Продолжений передачи файла после обрыва
+    std::chrono::milliseconds resume_timeout_{30s}; // Ожидание переподключения для продолжения
+    CodecRegistry codecs_;              // Кодеки сжатия в порядке предпочтения
+    static constexpr size_t FILE_CHUNK_SIZE = 63 * 1024; // Оптимальный размер для Base64
 
     enum class RequestMode {
         Async,  // Асинхронная отправка (по умолчанию)
@@ -230,25 +329,68 @@ public:
             : ctx_(2),
               adm_socket_(ctx_, zmq::socket_type::dealer),
               sub_socket_(ctx_, zmq::socket_type::sub),
+              wakeup_(ctx_),
               client_id_(std::move(id)),
               server_host_(std::move(server_host)),
-              last_heartbeat_time_(std::chrono::steady_clock::now()),
-              last_updates_()  // Инициализация пустым вектором
+              last_heartbeat_time_(std::chrono::steady_clock::now())
     {
         adm_socket_.set(zmq::sockopt::routing_id, client_id_);
-        sub_socket_.set(zmq::sockopt::subscribe, "");
+        // listen_loop спит до ближайшего срока: более ранний срок требует пересчёта таймаута
+        request_manager_.on_earlier_deadline([this] { wakeup_.notify(); });
     }
 
     ~TestClient() {
         stop();
     }
 
+    /**
+     * @brief Размер окна конвейерных запросов (максимум неподтверждённых запросов)
+     */
+    void set_async_window(size_t limit) {
+        // Больше ожидающих запросов, чем вмещает таблица корреляции, окно пропускать не должно
+        async_window_.set_limit(std::min<size_t>(limit, RequestManager::POOL_CAPACITY));
+    }
+
+    /**
+     * @brief Максимум сообщений, принимаемых из сокета за одно пробуждение listen_loop (до start())
+     */
+    void set_recv_batch_budget(size_t budget) {
+        recv_batch_budget_ = budget > 0 ? budget : 1;
+    }
+
+    /**
+     * @brief Файл кэша CRC32 файлов программ (по умолчанию - HashCache::default_path())
+     */
+    void set_hash_cache_path(const std::filesystem::path& path) {
+        hash_cache_.set_path(path);
+    }
+
+    /**
+     * @brief Число потоков разбора публикаций (до start()); 0 - разбор в потоке приёма
+     */
+    void set_pub_decode_threads(size_t threads) {
+        pub_decode_threads_ = threads;
+    }
+
     /**
      * @brief Запуск клиента
      */
     void start() {
         running_ = true;
 
+        // Потоки разбора публикаций должны работать раньше listen_loop
+        pub_decoders_.clear();
+        for (size_t i = 0; i < std::max<size_t>(pub_decode_threads_, 1); ++i) {
+            pub_decoders_.push_back(std::make_unique<PubDecoder>(client_id_));
+        }
+        if (pub_decode_threads_ > 0) {
+            pub_pool_.start(pub_decode_threads_, pub_queue_capacity_, 64,
+                            [this](size_t lane, PubFrame* frames, size_t count) {
+                                decode_pub_frames(lane, frames, count);
+                            },
+                            [this] { wakeup_.notify(); });  // Место в очереди - возобновить приём
+        }
+
         // Запускаем основные потоки
         connection_monitor_thread_ = std::thread(&TestClient::connection_and_heartbeat_loop, this);
         listen_thread_ = std::thread(&TestClient::listen_loop, this);
@@ -280,16 +422,17 @@ public:
             connection_monitor_thread_.join();
         }
 
-        // 4. Принудительная разблокировка listen_loop
+        // 4. Пробуждение и остановка listen_loop
         if (listen_thread_.joinable()) {
-            // Отправляем пустое сообщение для разблокировки zmq::poll
-            zmq::message_t wakeup_msg(0);
-            adm_socket_.send(wakeup_msg, zmq::send_flags::dontwait);
+            wakeup_.notify();
             listen_thread_.join();
         }
+        pub_pool_.stop();   // Разбирает оставшиеся в очередях публикации
+        request_manager_.cancel_all();  // expire() больше некому вызывать: ожидающие завершаются неудачей
 
         // 5. Закрытие сокетов
         cleanup_resources();
+        wakeup_.close();
 
         // 7. Закрытие контекста через деструктор или явно:
         ctx_.close();
@@ -337,44 +480,198 @@ private:
      * @param socket Сокет для отправки
      * @param msg Сообщение
      */
-    bool send_message(const json& message) {
+    bool send_message(json message) {
         Response response;
-        if (send_message(message, RequestMode::Sync, 3s, &response)) {
+        if (send_message(std::move(message), RequestMode::Sync, 3s, &response)) {
             return response.isSuccess();
         }
         return false;
 
     }
 
-    bool send_message(const json& message, RequestMode mode,
+    bool send_message(json message, RequestMode mode,
                       std::chrono::milliseconds timeout,
                       Response* out_response)
     {
-        std::shared_ptr<SyncRequest> sync_request;
-
-        if (mode == RequestMode::Sync) {
-            sync_request = request_manager_.create(
-                message["key"].get<std::string>(),
-                message["request"].get<std::string>()
-            );
-        }
+        RequestHandle sync_request;
 
         try {
-            zmq::message_t zmq_msg(message.dump());
-            adm_socket_.send(zmq_msg, zmq::send_flags::dontwait);
+            if (mode == RequestMode::Sync) {
+                sync_request = request_manager_.create(
+                    message["key"].get<std::string>(),
+                    message["request"].get<std::string>()
+                );
+                if (sync_request->ready()) return false;   // Таблица запросов переполнена
+                message["id"] = sync_request->id();  // Сервер возвращает id в ответе
+            }
+
+            if (!send_payload(message.dump())) {
+                if (sync_request) { request_manager_.cancel(*sync_request); }
+                return false;
+            }
         } catch (...) {
+            if (sync_request) { request_manager_.cancel(*sync_request); }
             return false;
         }
 
         if (mode == RequestMode::Sync) {
             // Ожидаем ответ
             bool bOk = sync_request->wait(*out_response, timeout);
+            if (!bOk) { request_manager_.cancel(*sync_request); }
             return bOk;
         }
 
         return true;
     }
 
+    /**
+     * @brief Конвейерная отправка запроса без ожидания ответа
+     * @param message Сообщение
+     * @param timeout Время ожидания ответа
+     * @param on_complete Обработчик завершения (вызывается из потока listen_loop)
+     * @return Дескриптор запроса: ready()/wait() для ожидания в стиле future
+     *
+     * Число неподтверждённых запросов ограничено окном async_window_:
+     * при заполненном окне вызов ждёт освобождения места не дольше timeout.
+     */
+    RequestHandle send_async(json message,
+                                            std::chrono::milliseconds timeout,
+                                            SyncRequest::Callback on_complete = {})
+    {
+        const auto key = message["key"].get<std::string>();
+        const auto request = message["request"].get<std::string>();
+        return send_async(key, request, [this, &message](uint64_t id) {
+            message["id"] = id;
+            return send_payload(message.dump());
+        }, timeout, std::move(on_complete));
+    }
+
+    /**
+     * @brief Конвейерная отправка DTO-запроса (id корреляции записывается в сам запрос)
+     */
+    RequestHandle send_async(Request& request,
+                                            std::chrono::milliseconds timeout,
+                                            SyncRequest::Callback on_complete = {})
+    {
+        return send_async(request.key, request.request, [this, &request](uint64_t id) {
+            request.id = id;
+            return send_payload(request.toJSON());
+        }, timeout, std::move(on_complete));
+    }
+
+    /**
+     * @brief Конвейерная отправка DTO-запроса с двоичными данными отдельным кадром
+     * @param payload Кадр данных (при успешной отправке владение передаётся ZeroMQ)
+     */
+    RequestHandle send_async(Request& request, zmq::message_t& payload,
+                                            std::chrono::milliseconds timeout,
+                                            SyncRequest::Callback on_complete = {})
+    {
+        return send_async(request.key, request.request, [this, &request, &payload](uint64_t id) {
+            request.id = id;
+            return send_frames(request.toJSON(), payload);
+        }, timeout, std::move(on_complete));
+    }
+
+    // send(id) сериализует запрос с id корреляции и отправляет его; false - отправка не удалась
+    template <typename Send>
+    RequestHandle send_async(const std::string& key, const std::string& request_name,
+                                            Send&& send,
+                                            std::chrono::milliseconds timeout,
+                                            SyncRequest::Callback on_complete)
+    {
+        const bool admitted = async_window_.acquire_for(timeout);
+        auto done = [this, admitted, cb = std::move(on_complete)](bool ok, const Response& response) {
+            if (admitted) async_window_.release();
+            if (cb) cb(ok, response);
+        };
+
+        RequestHandle request;
+        try {
+            request = request_manager_.create_async(key, request_name, std::move(done), timeout);
+            if (!admitted) {
+                request_manager_.cancel(*request);
+                return request;
+            }
+            if (request->ready()) return request;   // Таблица переполнена: запрос уже завершён неудачей
+            if (!send(request->id())) {
+                request_manager_.cancel(*request);
+            }
+        } catch (...) {
+            if (request) { request_manager_.cancel(*request); }
+            else if (admitted) { async_window_.release(); }
+        }
+        return request;
+    }
+
+#if defined(__cpp_impl_coroutine)
+public:
+    /**
+     * @brief Запрос для co_await: auto response = co_await client.request(Request{...});
+     * @param executor Исполнитель для возобновления сопрограммы (по умолчанию - поток listen_loop)
+     */
+    template <typename T>
+    RequestAwaitable request(T req, std::chrono::milliseconds timeout = 3s, ResumeExecutor executor = {}) {
+        static_assert(std::is_base_of_v<Request, T>, "T must inherit from Request");
+        std::string key = req.key;
+        std::string name = req.request;
+        return RequestAwaitable(std::move(key), std::move(name),
+                [this, req = std::move(req), timeout](SyncRequest::Callback cb) mutable {
+                    return send_async(req, timeout, std::move(cb));
+                }, std::move(executor));
+    }
+private:
+#endif
+
+    /**
+     * @brief Отправка готового сообщения в административный сокет
+     * @return false - сокеты сеанса не готовы; иначе сообщение поставлено в очередь listen_loop
+     */
+    bool send_payload(const std::string& payload) {
+        return enqueue_outgoing({zmq::message_t(payload), zmq::message_t(), false});
+    }
+
+    /**
+     * @brief Отправка двухкадрового сообщения: JSON-заголовок и двоичные данные
+     *
+     * Части сообщения ZeroMQ доставляет атомарно: если принят первый кадр, будет принят и второй.
+     * Данные payload переходят в очередь отправки.
+     */
+    bool send_frames(const std::string& header, zmq::message_t& payload) {
+        return enqueue_outgoing({zmq::message_t(header), std::move(payload), true});
+    }
+
+    bool enqueue_outgoing(OutgoingMessage message) {
+        {
+            std::lock_guard<std::mutex> lock(send_mutex_);
+            if (!sockets_ready_) return false;
+            outgoing_.push_back(std::move(message));
+            outgoing_pending_ = true;
+        }
+        wakeup_.notify();
+        return true;
+    }
+
+    /**
+     * @brief Отправка очереди outgoing_ в adm_socket_ (только listen_loop)
+     *
+     * Если сокет не принимает сообщения (достигнут HWM), остаток очереди ждёт ZMQ_POLLOUT.
+     */
+    void flush_outgoing() {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        while (!outgoing_.empty()) {
+            OutgoingMessage& message = outgoing_.front();
+            if (!message.has_payload) {
+                if (!adm_socket_.send(message.header, zmq::send_flags::dontwait)) break;
+            } else {
+                if (!adm_socket_.send(message.header, zmq::send_flags::sndmore | zmq::send_flags::dontwait)) break;
+                (void)adm_socket_.send(message.payload, zmq::send_flags::dontwait);
+            }
+            outgoing_.pop_front();
+        }
+        outgoing_pending_ = !outgoing_.empty();
+    }
+
     /**
      * @brief Отправка запроса на подключение
      */
@@ -384,12 +681,23 @@ private:
                 {"request", "connect"},
                 {"timeout", 3000}  // 3 секунды таймаут
         };
+        // Поддерживаемые форматы публикаций в порядке предпочтения
+        msg["pub_formats"] = binary_pub_ ? json{"binary", "json"} : json{"json"};
+        // Публикации нужны с первым кадром топика (SendValues::topicFrame) для фильтрации подписки
+        // в libzmq; фильтр включается, только если сервер подтвердит это в ответе
+        msg["pub_topic_frame"] = pub_topic_filter_;
+        // Чанки файла: данные вторым двоичным кадром ("frame") или base64 внутри JSON;
+        // кадр используется, только если сервер подтвердит его в ответе, иначе - base64
+        msg["file_chunk_payload"] = raw_file_chunks_ ? FileChunk::RAW_PAYLOAD : "base64";
 
         Response response;
         if (send_message(msg, RequestMode::Sync, 5s, &response)) {  // Увеличенный таймаут
             if (response.isSuccess()) {
                 // Дополнительная проверка ответа
                 if (response.result==200) {
+                    const auto reply = ConnectReply::fromResponse(response);
+                    if (pub_topic_filter_ && reply.pub_topic_frame) enable_topic_filter();
+                    raw_chunks_active_ = raw_file_chunks_ && reply.raw_file_chunks;
                     return true;
                 }
             } else if (debug_mode_) {
@@ -402,7 +710,77 @@ private:
         return false;
     }
 
+    /**
+     * @brief Подписка sub_socket_ на публикации топика (фильтрация выполняется в libzmq)
+     */
+    void subscribe_topic(const std::string& topic) {
+        std::lock_guard<std::mutex> lock(topics_mutex_);
+        auto prefix = SendValues::topicFrame(client_id_, topic);
+        if (pub_topics_.insert(prefix).second) {
+            topic_changes_.emplace_back(true, std::move(prefix));
+            topics_dirty_ = true;
+            wakeup_.notify();
+        }
+    }
+
+    void unsubscribe_topic(const std::string& topic) {
+        std::lock_guard<std::mutex> lock(topics_mutex_);
+        auto prefix = SendValues::topicFrame(client_id_, topic);
+        if (pub_topics_.erase(prefix) > 0) {
+            topic_changes_.emplace_back(false, std::move(prefix));
+            topics_dirty_ = true;
+            wakeup_.notify();
+        }
+    }
+
+    /**
+     * @brief Применение изменений подписки (только из listen_loop)
+     */
+    void apply_topic_changes() {
+        if (!topics_dirty_.exchange(false)) return;
+        std::lock_guard<std::mutex> lock(topics_mutex_);
+        if (pub_topic_frame_) {
+            for (const auto& [subscribe, prefix] : topic_changes_) {
+                if (subscribe) sub_socket_.set(zmq::sockopt::subscribe, prefix);
+                else           sub_socket_.set(zmq::sockopt::unsubscribe, prefix);
+            }
+        }
+        // Без кадра топика сокет подписан на всё, изменения учтены только в pub_topics_
+        topic_changes_.clear();
+    }
+
+    /**
+     * @brief Подписка нового sub_socket_ (при connect, до установки sockets_ready_)
+     *
+     * Поддерживает ли сервер кадр топика, станет известно из ответа на connect,
+     * поэтому новый сокет подписывается на всё (см. enable_topic_filter()).
+     */
+    void restore_subscriptions() {
+        std::lock_guard<std::mutex> lock(topics_mutex_);
+        topic_changes_.clear();
+        pub_topic_frame_ = false;
+        sub_socket_.set(zmq::sockopt::subscribe, "");
+    }
+
+    /**
+     * @brief Переход на подписку по топикам после подтверждения кадра топика сервером
+     *
+     * Сначала добавляются префиксы топиков, затем снимается подписка на всё, чтобы
+     * в переходе не терялись публикации. Применяется в listen_loop (apply_topic_changes()).
+     */
+    void enable_topic_filter() {
+        std::lock_guard<std::mutex> lock(topics_mutex_);
+        if (pub_topic_frame_) return;
+        pub_topic_frame_ = true;
+        topic_changes_.clear();
+        for (const auto& prefix : pub_topics_) topic_changes_.emplace_back(true, prefix);
+        topic_changes_.emplace_back(false, std::string{});
+        topics_dirty_ = true;
+        wakeup_.notify();
+    }
+
     bool send_subscribe(const std::vector<std::string>& tags) {
+        subscribe_topic("default");
         json msg = {
                 {"key", client_id_},
                 {"request", "subscribe_values"},
@@ -425,9 +803,29 @@ private:
                response.isSuccess();
     }
 
+    /**
+     * @brief Исключение сокетов из опроса listen_loop перед их закрытием
+     *
+     * Закрывать сокет, который другой поток держит в zmq_poll, нельзя: дожидаемся,
+     * пока listen_loop перестроит опрос без него. Вызывается без send_mutex_.
+     */
+    void detach_sockets() {
+        const uint32_t generation = ++sockets_generation_;
+        wakeup_.notify();
+        if (!listen_thread_.joinable() || std::this_thread::get_id() == listen_thread_.get_id()) return;
+        std::unique_lock<std::mutex> lock(poll_mutex_);
+        sockets_detached_.wait_for(lock, 1s, [&] {
+            return !running_ || static_cast<int32_t>(polled_generation_ - generation) >= 0;
+        });
+    }
+
     void cleanup_resources() {
+        sockets_ready_ = false;
+        detach_sockets();
+        std::lock_guard<std::mutex> send_lock(send_mutex_);
+        outgoing_.clear();          // Сообщения прежнего сеанса не отправляются: запросы истекут по сроку
+        outgoing_pending_ = false;
         try {
-            sockets_ready_ = false;
             if (adm_socket_.handle() != nullptr) {adm_socket_.close();}
             if (sub_socket_.handle() != nullptr) {sub_socket_.close();}
         } catch (...) {
@@ -445,15 +843,22 @@ private:
         bool result = false;
         cleanup_resources();
         try {
-            adm_socket_ = zmq::socket_t(ctx_, zmq::socket_type::dealer);
-            sub_socket_ = zmq::socket_t(ctx_, zmq::socket_type::sub);
-            adm_socket_.set(zmq::sockopt::routing_id, client_id_);
-            sub_socket_.set(zmq::sockopt::subscribe, "");
-
-            adm_socket_.connect("tcp://" + server_host_ + ":5551");
-            sub_socket_.connect("tcp://" + server_host_ + ":5552");
-
-            sockets_ready_ = true;
+            {
+                std::lock_guard<std::mutex> send_lock(send_mutex_);
+                adm_socket_ = zmq::socket_t(ctx_, zmq::socket_type::dealer);
+                sub_socket_ = zmq::socket_t(ctx_, zmq::socket_type::sub);
+                adm_socket_.set(zmq::sockopt::routing_id, client_id_);
+                restore_subscriptions();
+
+                adm_socket_.connect("tcp://" + server_host_ + ":5551");
+                sub_socket_.connect("tcp://" + server_host_ + ":5552");
+
+                sockets_ready_ = true;
+                ++sockets_generation_;
+                ++pub_session_;     // Словарь тегов двоичного формата начинается заново
+                raw_chunks_active_ = false;  // Подтверждается заново в ответе на connect
+            }
+            wakeup_.notify();       // listen_loop добавляет новые сокеты в опрос
 
             // Используем send_heartbeat вместо check_connection
             result = send_connect(); //send_heartbeat();
@@ -517,42 +922,125 @@ private:
 
     /* Основные обработчики */
 
+    /**
+     * @brief Таймаут опроса: до ближайшего срока асинхронного запроса, без сроков - бесконечный
+     */
+    std::chrono::milliseconds poll_timeout() {
+        auto deadline = request_manager_.next_deadline();
+        if (!deadline) return std::chrono::milliseconds(-1);
+        auto left = std::chrono::ceil<std::chrono::milliseconds>(*deadline - std::chrono::steady_clock::now());
+        return std::max(left, std::chrono::milliseconds(0));
+    }
+
     /**
      * @brief Цикл прослушивания сообщений
+     *
+     * Периодических пробуждений нет: опрос завершается сообщением сервера, сигналом wakeup_
+     * (остановка, замена сокетов, изменение подписки, более ранний срок запроса, исходящее
+     * сообщение) или сроком ближайшего асинхронного запроса. Набор опрашиваемых сокетов
+     * перестраивается только при смене их поколения. Сокеты сеанса использует только этот поток.
      */
     void listen_loop() {
-        while (running_) {
-            if (!sockets_ready_) { std::this_thread::sleep_for(100ms); continue; }
+        uint32_t generation = 0;
+        bool active = false;            // Сокеты сеанса включены в опрос
+        bool sub_polled = true;         // sub_socket_ опрашивается (нет кадра, ждущего очереди разбора)
+        bool adm_out_polled = false;    // adm_socket_ опрашивается и на ZMQ_POLLOUT (очередь не ушла целиком)
+        void* sub_handle = nullptr;
+        void* adm_handle = nullptr;
+#ifdef ZMQ_CLIENT_USE_POLLER
+        std::unique_ptr<zmq::poller_t<>> poller;
+        std::vector<zmq::poller_event<>> events(3);
+#else
+        std::array<zmq::pollitem_t, 3> items{};
+#endif
 
-            zmq::pollitem_t items[] = {
-                    {sub_socket_, 0, ZMQ_POLLIN, 0},
-                    {adm_socket_, 0, ZMQ_POLLIN, 0}
-            };
+        auto rebuild = [&] {
+            {
+                std::lock_guard<std::mutex> lock(send_mutex_);
+                generation = sockets_generation_;
+                active = sockets_ready_;
+                sub_handle = active ? sub_socket_.handle() : nullptr;
+                adm_handle = active ? adm_socket_.handle() : nullptr;
+#ifdef ZMQ_CLIENT_USE_POLLER
+                poller = std::make_unique<zmq::poller_t<>>();
+                poller->add(wakeup_.socket(), zmq::event_flags::pollin);
+                if (active) {
+                    poller->add(adm_socket_, zmq::event_flags::pollin);
+                    poller->add(sub_socket_, zmq::event_flags::pollin);
+                }
+#else
+                items[0] = {wakeup_.socket().handle(), 0, ZMQ_POLLIN, 0};
+                items[1] = {adm_handle, 0, ZMQ_POLLIN, 0};
+                items[2] = {sub_handle, 0, ZMQ_POLLIN, 0};
+#endif
+                sub_polled = true;
+                adm_out_polled = false;
+            }
+            {
+                std::lock_guard<std::mutex> lock(poll_mutex_);
+                polled_generation_ = generation;
+            }
+            sockets_detached_.notify_all();
+        };
 
-            try {
-                int rc = zmq::poll(items, 2, 100ms);
+        rebuild();
+        while (running_) {
+            request_manager_.expire();  // Просроченные конвейерные запросы
+            if (sockets_generation_ != generation) rebuild();
+            if (active) apply_topic_changes();
 
-                if (rc == -1 && errno == EINTR) {
-                    // Системный вызов был прерван, продолжаем работу
-                    if (debug_mode_) std::cout << "[ZMQ] Poll interrupted, continuing...\n";
-                    continue;
+            try {
+                // Пока принятый кадр ждёт места в очереди разбора, новые не принимаются:
+                // sub_socket_ исключается из опроса, поток разбора разбудит цикл через wakeup_
+                if (has_pending_pub_) dispatch_pending_pub();
+                const bool poll_sub = !has_pending_pub_;
+
+                // Исходящие сообщения других потоков; не ушедший остаток ждёт ZMQ_POLLOUT
+                if (active && outgoing_pending_) flush_outgoing();
+                const bool poll_out = active && outgoing_pending_;
+
+                bool wake = false, pub = false, adm = false;
+#ifdef ZMQ_CLIENT_USE_POLLER
+                if (active && poll_sub != sub_polled) {
+                    poller->modify(sub_socket_, poll_sub ? zmq::event_flags::pollin : zmq::event_flags::none);
+                    sub_polled = poll_sub;
+                }
+                if (active && poll_out != adm_out_polled) {
+                    poller->modify(adm_socket_, poll_out ? zmq::event_flags::pollin | zmq::event_flags::pollout
+                                                         : zmq::event_flags::pollin);
+                    adm_out_polled = poll_out;
+                }
+                const size_t count = poller->wait_all(events, poll_timeout());
+                for (size_t i = 0; i < count; ++i) {
+                    void* handle = events[i].socket.handle();
+                    const bool in = (events[i].events & zmq::event_flags::pollin) != zmq::event_flags::none;
+                    wake |= handle == wakeup_.socket().handle();
+                    pub  |= active && handle == sub_handle;
+                    adm  |= active && in && handle == adm_handle;
+                }
+#else
+                if (poll_out != adm_out_polled) {
+                    items[1].events = static_cast<short>(poll_out ? ZMQ_POLLIN | ZMQ_POLLOUT : ZMQ_POLLIN);
+                    adm_out_polled = poll_out;
+                }
+                const size_t polled = !active ? 1 : poll_sub ? 3 : 2;
+                if (zmq::poll(items.data(), polled, poll_timeout()) > 0) {
+                    wake = items[0].revents & ZMQ_POLLIN;
+                    adm  = polled > 1 && (items[1].revents & ZMQ_POLLIN);
+                    pub  = polled > 2 && (items[2].revents & ZMQ_POLLIN);
+                }
+#endif
+                if (wake) {
+                    wakeup_.drain();    // Состояние проверяется в начале следующей итерации
                 }
 
-                if (rc > 0) {
-                    if (items[0].revents & ZMQ_POLLIN) {
-                        handle_pub_message();
-                    }
+                // Ответы и heartbeat - раньше публикаций (см. handle_pub_messages)
+                if (adm) {
+                    handle_adm_messages();
+                }
 
-                    if (items[1].revents & ZMQ_POLLIN) {
-                        zmq::message_t msg;
-                        if (adm_socket_.recv(msg, zmq::recv_flags::dontwait)) {
-                            if (debug_mode_) {
-                                std::cout << "[ADM] Raw message: "
-                                          << msg.to_string_view() << "\n";
-                            }
-                            handle_adm_message(msg);
-                        }
-                    }
+                if (pub) {
+                    handle_pub_messages();
                 }
             }
             catch (const zmq::error_t& e) {
@@ -571,52 +1059,186 @@ private:
         }
     }
     /**
-     * @brief Обработчик сообщений от сервера (публикации)
+     * @brief Приём одной публикации из sub_socket_ без ожидания
      */
-    void handle_pub_message() {
-        zmq::message_t msg;
-        if (sub_socket_.recv(msg)) {
-            try {
-                auto update = SendValues::fromJSON(msg.to_string());
-                if (update.key == client_id_) {
-                    {
-                        std::lock_guard<std::mutex> lock(updates_mutex_);
-                        // Обновляем только те теги, которые пришли в сообщении
-                        for (const auto& new_tag : update.values) {
-                            bool found = false;
-                            for (auto& existing_tag : last_updates_) {
-                                if (existing_tag.key == new_tag.key) {
-                                    existing_tag = new_tag; // Обновляем существующий тег
-                                    found = true;
-                                    break;
-                                }
-                            }
-                            if (!found) {
-                                last_updates_.push_back(new_tag); // Добавляем новый тег
-                            }
-                        }
-                    }
+    bool receive_pub(zmq::message_t& msg) {
+        if (!sub_socket_.recv(msg, zmq::recv_flags::dontwait)) return false;
+        // Первый кадр - топик, по которому libzmq уже отфильтровал публикацию.
+        // Части сообщения доставляются вместе, поэтому остальные кадры уже получены
+        while (msg.more()) {
+            if (!sub_socket_.recv(msg, zmq::recv_flags::dontwait)) return false;
+        }
+        return true;
+    }
 
-                    if (debug_mode_) {
-                        std::cout << "\n[PUB] Received updates (" << update.values.size() << " tags)\n";
-                        for (const auto& tag : update.values) {
-                            std::cout << "  " << tag.key << " = " << tag.value
-                                      << " (" << toString(tag.quality) << ")\n";
-                        }
-                    }
-                }
-            } catch(const std::exception& e) {
-                if (debug_mode_) {
-                    std::cerr << "Failed to process update message: " << e.what() << "\n";
+    /**
+     * @brief Есть ли непрочитанные или ожидающие отправки административные сообщения (без ожидания и без опроса)
+     */
+    bool adm_pending() {
+        return outgoing_pending_ || (adm_socket_.get(zmq::sockopt::events) & ZMQ_POLLIN) != 0;
+    }
+
+    /**
+     * @brief Вычитывание публикаций из sub_socket_
+     *
+     * За одно пробуждение принимается до recv_batch_budget_ сообщений без повторного опроса.
+     * Кадры передаются потокам разбора; без них публикации разбираются здесь же
+     * и применяются к tag_store_ одним пакетом изменений.
+     * Ответы ADM (в том числе heartbeat) и исходящие запросы имеют строгий приоритет: каждые
+     * ADM_CHECK_INTERVAL публикаций проверяются adm_socket_ и очередь outgoing_, и при наличии
+     * сообщений вычитывание прерывается - listen_loop сразу обработает ADM, а оставшиеся
+     * публикации вернёт следующий опрос.
+     */
+    void handle_pub_messages() {
+        if (pub_pool_.lanes() == 0) {
+            PubDecoder& decoder = *pub_decoders_[0];
+            auto batch = tag_store_.batch();
+            zmq::message_t msg;
+            for (size_t received = 0; received < recv_batch_budget_; ++received) {
+                if (received > 0 && received % ADM_CHECK_INTERVAL == 0 && adm_pending()) break;
+                if (!receive_pub(msg)) break;
+                decode_pub_message(decoder, msg, pub_session_,
+                        [this, &batch](const std::string& key, uint64_t value, Quality quality,
+                                       sysclk::time_point timestamp) {
+                            apply_tag_update(batch, key, value, quality, timestamp);
+                        });
+            }
+            return;
+        }
+
+        for (size_t received = 0; received < recv_batch_budget_; ++received) {
+            if (received > 0 && received % ADM_CHECK_INTERVAL == 0 && adm_pending()) break;
+            if (!has_pending_pub_) {
+                if (!receive_pub(pending_pub_.msg)) break;
+                pending_pub_.order = ++pub_order_;
+                pending_pub_.session = pub_session_;
+                has_pending_pub_ = true;
+            }
+            if (!dispatch_pending_pub()) return;
+        }
+    }
+
+    /**
+     * @brief Передача принятого кадра потоку разбора
+     *
+     * Двоичные публикации зависят от словаря тегов, пополняемого по ходу потока,
+     * поэтому все они разбираются по порядку в потоке 0. JSON-публикации независимы
+     * и распределяются по кругу; порядок значений одного тега восстанавливает
+     * tag_store_ по номеру публикации.
+     * @return false - очереди заполнены, кадр остаётся в pending_pub_
+     */
+    bool dispatch_pending_pub() {
+        auto try_dispatch = [this] {
+            if (SendValues::isBinary(pending_pub_.msg.data(), pending_pub_.msg.size())) {
+                return pub_pool_.try_push(0, pending_pub_);
+            }
+            const size_t lanes = pub_pool_.lanes();
+            for (size_t i = 0; i < lanes; ++i) {
+                if (pub_pool_.try_push(next_pub_lane_++ % lanes, pending_pub_)) return true;
+            }
+            return false;
+        };
+
+        if (!try_dispatch()) {
+            pub_pool_.pause();
+            if (!try_dispatch()) return false;  // Повтор после pause(): место могло освободиться
+        }
+        pub_pool_.resume();
+        has_pending_pub_ = false;
+        return true;
+    }
+
+    /**
+     * @brief Разбор пакета публикаций в потоке pub_pool_
+     *
+     * Разбор идёт без блокировок; к tag_store_ применяется только готовый пакет тегов.
+     */
+    void decode_pub_frames(size_t lane, PubFrame* frames, size_t count) {
+        PubDecoder& decoder = *pub_decoders_[lane];
+        decoder.update_count = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const uint64_t order = frames[i].order;
+            decode_pub_message(decoder, frames[i].msg, frames[i].session,
+                    [&decoder, order](const std::string& key, uint64_t value, Quality quality,
+                                      sysclk::time_point timestamp) {
+                        if (decoder.update_count == decoder.updates.size()) decoder.updates.emplace_back();
+                        PubUpdate& update = decoder.updates[decoder.update_count++];
+                        update.key.assign(key);
+                        update.value = value;
+                        update.quality = quality;
+                        update.timestamp = timestamp;
+                        update.order = order;
+                    });
+        }
+        if (decoder.update_count == 0) return;
+
+        // Исключение в потоке разбора завершило бы процесс: остаток пакета теряется, поток продолжает работу
+        try {
+            auto batch = tag_store_.batch();
+            for (size_t i = 0; i < decoder.update_count; ++i) {
+                const PubUpdate& update = decoder.updates[i];
+                apply_tag_update(batch, update.key, update.value, update.quality, update.timestamp, update.order);
+            }
+        } catch (const std::exception& e) {
+            if (debug_mode_) {
+                std::cerr << "Failed to apply tag updates: " << e.what() << "\n";
+            }
+        } catch (...) {
+            if (debug_mode_) {
+                std::cerr << "Failed to apply tag updates (unknown error)\n";
+            }
+        }
+    }
+
+    /**
+     * @brief Разбор одной публикации сервера
+     * @param sink Приёмник тегов: sink(key, value, quality, timestamp)
+     */
+    template <typename Sink>
+    void decode_pub_message(PubDecoder& decoder, const zmq::message_t& msg, uint32_t session, Sink&& sink) {
+        try {
+            if (SendValues::isBinary(msg.data(), msg.size())) {
+                if (decoder.dictionary_session != session) {
+                    decoder.dictionary_session = session;
+                    decoder.dictionary.clear();     // Имена нового сеанса придут с повтором (см. TagDictionary)
                 }
-            } catch(...) {
-                if (debug_mode_) {
-                    std::cerr << "Failed to process update message (unknown error)\n";
+                auto update = SendValues::fromBinary(msg.data(), msg.size(), decoder.dictionary);
+                if (update.key == client_id_) {
+                    for (const auto& tag : update.values) {
+                        sink(tag.key, tag.value, tag.quality, tag.timestamp);
+                    }
                 }
+                return;
+            }
+
+            // JSON разбирается потоково, теги сразу попадают в приёмник
+            long applied = decoder.reader.read(static_cast<const char*>(msg.data()), msg.size(), sink);
+            if (applied < 0 && debug_mode_) {
+                std::cerr << "Failed to process update message: " << decoder.reader.error() << "\n";
+            }
+        } catch(const std::exception& e) {
+            if (debug_mode_) {
+                std::cerr << "Failed to process update message: " << e.what() << "\n";
+            }
+        } catch(...) {
+            if (debug_mode_) {
+                std::cerr << "Failed to process update message (unknown error)\n";
             }
         }
     }
 
+    /**
+     * @brief Обновление одного тега в хранилище в рамках пакета изменений
+     */
+    void apply_tag_update(TagStore::Batch& batch, const std::string& key, uint64_t value,
+                          Quality quality, sysclk::time_point timestamp, uint64_t order = 0) {
+        batch.set(key, value, quality, timestamp, order);
+
+        if (debug_mode_) {
+            std::cout << "[PUB] " << key << " = " << value << " (" << toString(quality) << ")\n";
+        }
+    }
+
     void readTagValue() {
         std::cout << "Enter tag name: ";
         std::string tag_name;
@@ -669,32 +1291,49 @@ private:
     }
 
     /**
-     * @brief Обработчик административных сообщений
+     * @brief Вычитывание административных сообщений из adm_socket_
+     *
+     * Принимается до recv_batch_budget_ сообщений за пробуждение; разобранные ответы
+     * передаются в request_manager_ одним пакетом.
      */
-    void handle_adm_message(zmq::message_t& msg) {
-        try {
-            auto response = Response::fromJSON(msg.to_string());
-
-            // Сначала пробуем обработать как синхронный ответ
-            if (!request_manager_.process_response(response))
-            {
-                // Обработка асинхронных сообщений
-                if (response.request == "heartbeat") {
-                    update_heartbeat_time();
-                    return;
-                }
-
-                // ... другая асинхронная обработка
+    void handle_adm_messages() {
+        adm_batch_.clear();
+        zmq::message_t msg;
+        for (size_t received = 0; received < recv_batch_budget_; ++received) {
+            if (!adm_socket_.recv(msg, zmq::recv_flags::dontwait)) break;
+            if (debug_mode_) {
+                std::cout << "[ADM] Raw message: "
+                          << msg.to_string_view() << "\n";
+            }
+            try {
+                adm_batch_.push_back(Response::fromJSON(msg.to_string()));
+            } catch(const json::exception& e) {
                 if (debug_mode_) {
-                    std::cout << "[ADM] Response: " << response.toJSON() << "\n";
+                    std::cerr << "Failed to parse response: " << e.what() << "\n";
                 }
-
-            }
-        } catch(const json::exception& e) {
-            if (debug_mode_) {
-                std::cerr << "Failed to parse response: " << e.what() << "\n";
             }
         }
+
+        // Сначала пробуем обработать как ответы на запросы
+        request_manager_.process_responses(adm_batch_, [this](const Response& response) {
+            handle_adm_message(response);
+        });
+    }
+
+    /**
+     * @brief Обработчик административного сообщения, не являющегося ответом на запрос
+     */
+    void handle_adm_message(const Response& response) {
+        // Обработка асинхронных сообщений
+        if (response.request == "heartbeat") {
+            update_heartbeat_time();
+            return;
+        }
+
+        // ... другая асинхронная обработка
+        if (debug_mode_) {
+            std::cout << "[ADM] Response: " << response.toJSON() << "\n";
+        }
     }
 
 //    void handle_adm_message(zmq::message_t& msg) {
@@ -725,8 +1364,7 @@ private:
 //    }
 
     std::vector<Tag> getLastUpdates() {
-        std::lock_guard<std::mutex> lock(updates_mutex_);
-        return last_updates_;
+        return tag_store_.snapshot();
     }
 
     /**
@@ -939,7 +1577,8 @@ private:
                     {"topic", "default_topic"},
                     {"keys", tags}
             };
-            adm_socket_.send(zmq::buffer(msg.dump()));
+            subscribe_topic("default_topic");
+            send_payload(msg.dump());
         }
 
         std::cout << "Subscribed to " << tags.size() << " tags\n";
@@ -957,6 +1596,7 @@ private:
                 {"topic", "default_topic"}
         };
         send_message(msg);
+        unsubscribe_topic("default_topic");
         std::cout << "Unsubscribe request sent\n";
     }
 
@@ -1017,25 +1657,114 @@ private:
      * @param file_paths Пути к файлам программы
      */
     void send_program(const std::string& program_name, const std::vector<std::string>& file_paths) {
-        uint64_t program_hash = calculate_program_hash(file_paths);
+        // Каждый файл отображается в память один раз: то же отображение используется
+        // и для хеша программы, и для нарезки на чанки
+        std::vector<std::shared_ptr<const utils::MappedFile>> files;
+        files.reserve(file_paths.size());
+        try {
+            for (const auto& file_path : file_paths) {
+                files.push_back(utils::MappedFile::open(file_path));
+            }
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return;
+        }
 
+        // С манифестом CRC каждого файла нужен заранее (неизменившиеся файлы - из hash_cache_).
+        // Без него, с prog_hash_trailer_, хеш считается по ходу отправки и передаётся в prog_end:
+        // файлы проходятся один раз. Иначе - заранее, отдельным проходом
         json prog_start = {
                 {"key", client_id_},
                 {"request", "prog_start"},
-                {"prog_name", program_name},
-                {"prog_hash", program_hash}
+                {"prog_name", program_name}
         };
-        send_message(prog_start);
+        // Файлы называются путём относительно корня программы: одноимённые файлы
+        // из разных каталогов различаются и в манифесте, и в списке need
+        const auto names = program_file_names(files);
+        const bool trailer = prog_hash_trailer_ && !prog_manifest_;
+        uint64_t program_hash = 0;
+        if (prog_manifest_) {
+            std::vector<uint32_t> crcs;
+            try {
+                crcs = calculate_file_crcs(files);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;     // Файл укорочен после отображения
+                return;
+            }
+            auto& manifest = prog_start["files"] = json::array();
+            for (size_t i = 0; i < files.size(); ++i) {
+                manifest.push_back({
+                        {"name", names[i]},
+                        {"size", files[i]->size()},
+                        {"crc", crcs[i]}
+                });
+                program_hash = combine_program_hash(program_hash, crcs[i], files[i]->size());
+            }
+            prog_start["prog_hash"] = program_hash;
+        } else if (trailer) {
+            prog_start["prog_hash_trailer"] = true;
+        } else {
+            try {
+                program_hash = calculate_program_hash(files);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+                return;
+            }
+            prog_start["prog_hash"] = program_hash;
+        }
+        // Программа уже загружалась: файлы передаются дельтой относительно прежней версии
+        const auto deployed = deployed_programs_.find(program_name);
+        const bool delta = delta_block_size_ != 0 && deployed != deployed_programs_.end();
+        if (delta) {
+            prog_start["base_hash"] = deployed->second;
+        }
+        Response start_response;
+        send_message(prog_start, RequestMode::Sync, 5s, &start_response);
+
+        // Сервер перечислил файлы, которых у него нет (data.need): остальные не передаются
+        auto pending = files;
+        auto pending_names = names;
+        if (prog_manifest_) {
+            if (auto need = ProgStart::need(start_response)) {
+                std::set<std::string> needed(need->begin(), need->end());
+                pending.clear();
+                pending_names.clear();
+                for (size_t i = 0; i < files.size(); ++i) {
+                    if (needed.count(names[i]) == 0) continue;
+                    pending.push_back(files[i]);
+                    pending_names.push_back(names[i]);
+                }
+                if (debug_mode_) {
+                    std::cout << "Server needs " << pending.size() << " of " << files.size() << " files\n";
+                }
+            }
+        }
 
-        for (const auto& file_path : file_paths) {
-            send_file(file_path);
+        std::vector<uint32_t> crcs;
+        if (upload_streams_ > 1 && pending.size() > 1) {
+            crcs = send_files_interleaved(pending, pending_names, delta);
+        } else {
+            for (size_t i = 0; i < pending.size(); ++i) {
+                crcs.push_back(send_file(pending[i], delta, pending_names[i]));
+            }
+        }
+        if (trailer) {
+            for (size_t i = 0; i < pending.size(); ++i) {
+                program_hash = combine_program_hash(program_hash, crcs[i], pending[i]->size());
+            }
         }
 
         json prog_end = {
                 {"key", client_id_},
                 {"request", "prog_end"}
         };
-        send_message(prog_end);
+        if (trailer) {
+            prog_end["prog_hash"] = program_hash;
+        }
+        // Сервер принял программу - она станет базой для следующей дельта-загрузки
+        if (send_message(prog_end)) {
+            deployed_programs_[program_name] = program_hash;
+        }
     }
 
     /**
@@ -1043,91 +1772,386 @@ private:
      * @param file_path Путь к файлу
      */
     void send_file(const std::string& file_path) {
-        fs::path path(file_path);
-        std::string file_name = path.filename().string();
-        uint64_t file_size = fs::file_size(path);
+        std::shared_ptr<const utils::MappedFile> file;
+        try {
+            file = utils::MappedFile::open(file_path);
+        } catch (const std::exception&) {
+            std::cerr << "Failed to open file: " << file_path << std::endl;
+            return;
+        }
+        send_file(file);
+    }
+
+    /**
+     * @brief Отправка одного файла, отображённого в память
+     * @param file Отображение файла (чанки ссылаются на него без копирования)
+     * @param delta Передать только блоки, которых нет в базовой версии программы
+     * @param name Имя файла для сервера (пустое - имя файла без каталога)
+     * @return CRC32 файла, рассчитанный по ходу отправки чанков
+     */
+    uint32_t send_file(const std::shared_ptr<const utils::MappedFile>& file, bool delta = false,
+                       const std::string& name = {}) {
+        FileUpload upload(file, 0, std::make_shared<TransferTracker>(transfer_window_), name);
+        begin_upload(upload, delta);
+        do {
+            while (!upload.sent()) {
+                send_next_chunk(upload);
+            }
+            // Ждём подтверждения последнего чанка (оно кумулятивно подтверждает остальные)
+            upload.tracker->wait_idle(5s);
+        } while (!upload.complete() && resume_upload(upload));
+        return finish_upload(upload);
+    }
+
+    /**
+     * @brief Одновременная отправка нескольких файлов
+     * @param files Отображённые в память файлы
+     * @param names Имена файлов для сервера (в порядке files)
+     * @param delta Передавать только блоки, которых нет в базовой версии программы
+     * @return CRC32 файлов в порядке files
+     *
+     * До upload_streams_ файлов передаются одновременно: их чанки чередуются в общем окне
+     * transfer_window_, поэтому мелкие файлы не ждут окончания крупных.
+     * Каждый файл получает свой stream (начиная с 1).
+     */
+    std::vector<uint32_t> send_files_interleaved(const std::vector<std::shared_ptr<const utils::MappedFile>>& files,
+                                                 const std::vector<std::string>& names,
+                                                 bool delta = false) {
+        auto window = std::make_shared<InFlightWindow>(transfer_window_);
+        std::vector<uint32_t> crcs(files.size());
+        std::vector<std::pair<size_t, FileUpload>> active;   // Индекс в files и состояние передачи
+        size_t next = 0;
+
+        auto start_next = [&] {
+            while (active.size() < upload_streams_ && next < files.size()) {
+                FileUpload upload(files[next], static_cast<uint32_t>(next + 1),
+                                  std::make_shared<TransferTracker>(window), names[next]);
+                begin_upload(upload, delta);
+                active.emplace_back(next++, std::move(upload));
+            }
+        };
+
+        start_next();
+        while (!active.empty()) {
+            // По одному чанку от каждого файла за проход
+            bool sending = false;
+            for (auto& entry : active) {
+                if (!entry.second.sent()) {
+                    send_next_chunk(entry.second);
+                    sending = true;
+                }
+            }
 
-        // 1. Отправляем file_start
+            // Файлы, чанки которых отправлены, завершаем сразу после подтверждения,
+            // а если отправлять больше нечего - с ожиданием подтверждения
+            for (auto it = active.begin(); it != active.end(); ) {
+                if (it->second.sent() && (!sending || it->second.tracker->idle())) {
+                    it->second.tracker->wait_idle(5s);
+                    if (!it->second.complete() && resume_upload(it->second)) {
+                        ++it;   // Передача продолжается с подтверждённого места
+                        continue;
+                    }
+                    crcs[it->first] = finish_upload(it->second);
+                    it = active.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            start_next();
+        }
+        return crcs;
+    }
+
+    /**
+     * @brief Начало передачи файла (file_start)
+     * @param delta Запросить у сервера блоки базовой версии (block_query) и передавать только недостающие
+     * @return false - сервер не принял file_start или не ответил
+     */
+    bool begin_upload(FileUpload& upload, bool delta = false) {
         json file_start = {
                 {"key", client_id_},
                 {"request", "file_start"},
-                {"file_name", file_name},
-                {"file_size", file_size}
+                {"file_name", upload.name},
+                {"file_size", upload.size()}
         };
-        send_message(file_start);
-
-        std::ifstream file(file_path, std::ios::binary);
-        if (!file.is_open()) {
-            std::cerr << "Failed to open file: " << file_path << std::endl;
-            return;
+        if (upload.stream != 0) file_start["stream"] = upload.stream;
+
+        // Дельта-режим прежней попытки (при продолжении передачи) действует, только если
+        // сервер снова подтвердит блоки: иначе file_start без block_size, а чанки - по missing
+        upload.use_whole_file();
+        if (delta && upload.size() > delta_block_size_ && !upload.file->truncated()) {
+            BlockQuery query(client_id_, upload.name, upload.size(), delta_block_size_,
+                             upload.signatures(delta_block_size_));
+            Response response;
+            auto request = send_async(query, 5s);
+            if (request && request->wait(response, 5s) && response.isSuccess()) {
+                upload.use_blocks(delta_block_size_, query.blocks.size(), query.have(response));
+                file_start["block_size"] = delta_block_size_;
+                if (debug_mode_) {
+                    std::cout << "Delta " << upload.name << ": " << upload.missing.size()
+                              << " of " << query.blocks.size() << " blocks to send\n";
+                }
+            }
+            // Сервер не знает базовую версию - файл передаётся целиком
+        }
+        // Предлагаем кодеки сжатия; сервер выбирает один в ответе (data.codec)
+        if (compress_files_) {
+            file_start["codecs"] = codecs_.names();
+        }
+        Response response;
+        if (send_message(file_start, RequestMode::Sync, 3s, &response) && response.isSuccess()) {
+            upload.codec = codecs_.find(FileStart::codec(response));
+            return true;
         }
+        return false;
+    }
 
-        const size_t CHUNK_SIZE = 63 * 1024; // Оптимальный размер для Base64
-        std::vector<char> buffer(CHUNK_SIZE);
-        uint64_t total_sent = 0;
+    /**
+     * @brief Продолжение прерванной передачи файла
+     * @return false - продолжить нельзя (нет соединения или исчерпаны попытки)
+     *
+     * Дожидается переподключения (его выполняет connection_and_heartbeat_loop), запрашивает
+     * у сервера подтверждённое смещение файла (file_status) и продолжает передачу с него.
+     * Заново с file_start файл начинается только по явному отказу сервера (он передачу не помнит);
+     * если ответа нет, запрос повторяется после переподключения, пока не истечёт resume_timeout_.
+     */
+    bool resume_upload(FileUpload& upload) {
+        if (upload.truncated || upload.resumes >= max_resume_attempts_) return false;
+        ++upload.resumes;
 
-        // 2. Отправляем чанки файла
-        while (file) {
-            file.read(buffer.data(), buffer.size());
-            size_t bytes_read = file.gcount();
+        const auto deadline = std::chrono::steady_clock::now() + resume_timeout_;
+        json status = {
+                {"key", client_id_},
+                {"request", "file_status"},
+                {"file_name", upload.name},
+                {"file_size", upload.size()}
+        };
+        if (upload.stream != 0) status["stream"] = upload.stream;
+        const bool delta = upload.block_size != 0;
 
-            if (bytes_read > 0) {
-                std::string chunk_data(buffer.data(), bytes_read);
-                std::string encoded = utils::base64_encode(chunk_data);
+        for (bool retry = false; ; retry = true) {
+            if (retry) std::this_thread::sleep_for(200ms);
+            while (running_ && !connection_ok_ && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(200ms);
+            }
+            if (!running_ || !connection_ok_ || std::chrono::steady_clock::now() >= deadline) return false;
 
-                json file_chunk = {
-                        {"key", client_id_},
-                        {"request", "file_chunk"},
-                        {"chunk_data", encoded},
-                        {"chunk_size", bytes_read} // Оригинальный размер, не закодированный
-                };
+            Response response;
+            if (!send_message(status, RequestMode::Sync, 3s, &response)) {
+                continue;   // Нет ответа - сервер мог сохранить передачу, спрашиваем снова
+            }
 
-                if (!send_message(file_chunk)) {
-                    std::cerr << "Failed to send chunk" << std::endl;
-                    break;
-                }
+            uint64_t committed = 0;
+            if (auto offset = response.isSuccess() ? FileStatus::offset(response) : std::nullopt) {
+                committed = *offset;
+            } else if (!begin_upload(upload, delta)) {
+                continue;   // Передача на сервере не начата заново - повторяем с file_status
+            }
 
-                total_sent += bytes_read;
-                if (debug_mode_) {
-                    float progress = (total_sent * 100.0f) / file_size;
-                    std::cout << "\rProgress: " << std::fixed << std::setprecision(1)
-                              << progress << "% (" << total_sent << "/" << file_size << ")";
-                    std::cout.flush();
-                }
+            upload.rewind(committed, std::make_shared<TransferTracker>(upload.tracker->window()));
+            if (debug_mode_) {
+                std::cout << "\nResuming " << upload.name << " from offset " << committed
+                          << " (attempt " << upload.resumes << ")\n";
             }
+            return true;
         }
+    }
+
+    /**
+     * @brief Отправка очередного чанка файла без ожидания ответа
+     * @return false - окно не освободилось или сервер отклонил чанк, передача прервана
+     */
+    bool send_next_chunk(FileUpload& upload) {
+        auto tracker = upload.tracker;
+        // Обращение к отображению за новым концом укороченного файла завершило бы процесс (SIGBUS)
+        if (upload.file->truncated()) {
+            upload.truncated = true;
+            upload.aborted = true;
+            return false;
+        }
+        if (tracker->failed() || !tracker->acquire(3s)) {
+            upload.aborted = true;
+            return false;
+        }
+
+        size_t length = 0;
+        const uint8_t* chunk_bytes = upload.next_chunk(FILE_CHUNK_SIZE, length);  // CRC считается попутно
+        const uint64_t chunk_seq = upload.seq;
+        auto on_complete = [this, tracker, chunk_seq](bool acked, const Response& response) {
+            for (auto& covered : tracker->complete(chunk_seq, acked,
+                                                   acked && !response.isSuccess())) {
+                request_manager_.cancel(*covered);
+            }
+        };
+
+        // Сжатие, если сервер согласовал кодек и оно уменьшает чанк
+        std::unique_ptr<std::vector<uint8_t>> packed;
+        if (upload.codec) {
+            packed = std::make_unique<std::vector<uint8_t>>(upload.codec->max_compressed_size(length));
+            const size_t packed_size = upload.codec->compress(chunk_bytes, length, packed->data(), packed->size());
+            if (packed_size > 0 && packed_size < length) {
+                packed->resize(packed_size);
+            } else {
+                packed.reset();
+            }
+        }
+        const std::string codec = packed ? upload.codec->name() : std::string{};
+
+        tracker->begin(chunk_seq);
+        RequestHandle request;
+        if (raw_chunks_active_) {
+            auto chunk = FileChunk::header(client_id_, length, chunk_seq, upload.stream);
+            if (upload.block_size != 0) chunk.block = upload.block;
+            chunk.codec = codec;
+            chunk.offset = upload.chunk_offset;
+            zmq::message_t payload;
+            if (packed) {
+                // Кадр владеет буфером сжатых данных
+                auto* buffer = packed.release();
+                payload = zmq::message_t(buffer->data(), buffer->size(),
+                        [](void*, void* hint) { delete static_cast<std::vector<uint8_t>*>(hint); }, buffer);
+            } else {
+                // Кадр ссылается прямо на отображение; копия shared_ptr удерживает его
+                // до освобождения кадра ZeroMQ
+                payload = zmq::message_t(const_cast<uint8_t*>(chunk_bytes), length,
+                        [](void*, void* hint) { delete static_cast<std::shared_ptr<const utils::MappedFile>*>(hint); },
+                        new std::shared_ptr<const utils::MappedFile>(upload.file));
+            }
+            request = send_async(chunk, payload, 3s, std::move(on_complete));
+        } else {
+            auto encoded = packed ? utils::base64_encode(packed->data(), packed->size())
+                                  : utils::base64_encode(chunk_bytes, length);
+            FileChunk chunk(client_id_, std::move(encoded),
+                            length, chunk_seq);  // Оригинальный размер, не закодированный
+            chunk.stream = upload.stream;
+            if (upload.block_size != 0) chunk.block = upload.block;
+            chunk.codec = codec;
+            chunk.offset = upload.chunk_offset;
+            request = send_async(chunk, 3s, std::move(on_complete));
+        }
+        if (!tracker->attach(chunk_seq, request)) {
+            request_manager_.cancel(*request);
+        }
+
+        if (debug_mode_ && upload.stream == 0) {
+            float progress = (upload.offset * 100.0f) / upload.size();
+            std::cout << "\rProgress: " << std::fixed << std::setprecision(1)
+                      << progress << "% (" << upload.offset << "/" << upload.size() << ")";
+            std::cout.flush();
+        }
+        return true;
+    }
+
+    /**
+     * @brief Завершение передачи файла (file_end)
+     * @return CRC32 файла
+     */
+    uint32_t finish_upload(FileUpload& upload) {
+        if (upload.truncated) {
+            std::cerr << "File was truncated during upload: " << upload.name << std::endl;
+        } else if (!upload.complete()) {
+            std::cerr << "Failed to send chunk" << std::endl;
+        }
+        const uint32_t crc = upload.finish_crc();
 
-        // 3. Отправляем file_end
         json file_end = {
                 {"key", client_id_},
                 {"request", "file_end"}
         };
+        if (upload.stream != 0) file_end["stream"] = upload.stream;
         send_message(file_end);
 
         if (debug_mode_) {
-            std::cout << "\nFile transfer completed: " << file_name
-                      << " (" << file_size << " bytes)" << std::endl;
+            std::cout << "\nFile transfer completed: " << upload.name
+                      << " (" << upload.size() << " bytes)" << std::endl;
         }
+        return crc;
+    }
+
+    /**
+     * @brief CRC32 файлов программы
+     * @param files Отображённые в память файлы программы
+     * @return CRC32 в порядке files
+     *
+     * Неизменившиеся файлы (то же время изменения и размер) берутся из hash_cache_,
+     * остальные считаются параллельно в пуле потоков.
+     */
+    std::vector<uint32_t> calculate_file_crcs(const std::vector<std::shared_ptr<const utils::MappedFile>>& files) {
+        std::vector<uint32_t> result(files.size());
+        if (files.empty()) return result;
+        {
+            ThreadPool pool(std::min<size_t>(files.size(), std::max(1u, std::thread::hardware_concurrency())));
+            std::vector<std::future<uint32_t>> crcs;
+            crcs.reserve(files.size());
+            for (const auto& file : files) {
+                crcs.push_back(pool.submit([this, &file] { return hash_cache_.file_crc32(*file); }));
+            }
+            for (size_t i = 0; i < files.size(); ++i) {
+                result[i] = crcs[i].get();
+            }
+        }
+        hash_cache_.save();
+        return result;
+    }
+
+    /**
+     * @brief Имена файлов программы для сервера: пути относительно корня программы
+     * @return Имена в порядке files, с разделителем '/'
+     *
+     * Корень программы - общий каталог всех файлов; файл программы из одного файла
+     * называется просто по имени.
+     */
+    static std::vector<std::string> program_file_names(const std::vector<std::shared_ptr<const utils::MappedFile>>& files) {
+        std::vector<fs::path> paths;
+        paths.reserve(files.size());
+        for (const auto& file : files) {
+            std::error_code ec;
+            auto absolute = fs::absolute(file->path(), ec);
+            paths.push_back((ec ? file->path() : absolute).lexically_normal());
+        }
+
+        fs::path root;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            const fs::path dir = paths[i].parent_path();
+            if (i == 0) { root = dir; continue; }
+            fs::path common;
+            for (auto a = root.begin(), b = dir.begin(); a != root.end() && b != dir.end() && *a == *b; ++a, ++b) {
+                common /= *a;
+            }
+            root = common;
+        }
+
+        std::vector<std::string> names;
+        names.reserve(paths.size());
+        for (const auto& path : paths) {
+            const auto relative = path.lexically_relative(root);
+            names.push_back(relative.empty() ? path.filename().generic_string() : relative.generic_string());
+        }
+        return names;
     }
 
     /**
      * @brief Расчет хеша программы
-     * @param file_paths Пути к файлам программы
-     * @return Хеш программы
+     * @param files Отображённые в память файлы программы
+     * @return Хеш программы (комбинирование XOR не зависит от порядка файлов)
      */
-    static uint64_t calculate_program_hash(const std::vector<std::string>& file_paths) {
+    uint64_t calculate_program_hash(const std::vector<std::shared_ptr<const utils::MappedFile>>& files) {
+        const auto crcs = calculate_file_crcs(files);
         uint64_t combined_hash = 0;
-
-        for (const auto& file_path : file_paths) {
-            uint32_t file_crc = utils::calculate_file_crc32(file_path);
-            uint64_t file_size = fs::file_size(file_path);
-            combined_hash ^= (static_cast<uint64_t>(file_crc) << 32) | file_size;
+        for (size_t i = 0; i < files.size(); ++i) {
+            combined_hash = combine_program_hash(combined_hash, crcs[i], files[i]->size());
         }
 
         return combined_hash;
     }
+
+    // Вклад файла в хеш программы (XOR, поэтому порядок файлов не важен)
+    static uint64_t combine_program_hash(uint64_t hash, uint32_t file_crc, uint64_t file_size) {
+        return hash ^ ((static_cast<uint64_t>(file_crc) << 32) | file_size);
+    }
 };
 
+#ifndef ZMQ_CLIENT_NO_MAIN   // Тесты включают этот файл со своей точкой входа
 /**
  * @brief Точка входа в программу
  */
@@ -1161,4 +2185,5 @@ int main() {
         std::terminate();
     }
     return 0;
-}
\ No newline at end of file
+}
+#endif // ZMQ_CLIENT_NO_MAIN
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Пул потоков фиксированного размера для фоновых вычислений
+ *
+ * Задачи выполняются в порядке поступления; результат возвращается через std::future.
+ * Деструктор дожидается выполнения всех поставленных задач.
+ */
+class ThreadPool {
+    std::mutex mutex_{};
+    std::condition_variable cv_{};
+    std::queue<std::function<void()>> tasks_{};
+    std::vector<std::thread> workers_{};
+    bool stopping_ = false;
+
+    void run() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) return;     // stopping_ и очередь пуста
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            task();
+        }
+    }
+
+public:
+    // threads == 0 - по числу аппаратных потоков
+    explicit ThreadPool(size_t threads = 0) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        workers_.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back([this] { run(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (auto& worker : workers_) worker.join();
+    }
+
+    [[nodiscard]] size_t size() const { return workers_.size(); }
+
+    template <typename F>
+    auto submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+        // std::function требует копируемости - задача хранится через shared_ptr
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        auto result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.emplace([task] { (*task)(); });
+        }
+        cv_.notify_one();
+        return result;
+    }
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "inflight_window.h"
+#include "sync_request.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Учёт чанков файла, отправленных скользящим окном
+ *
+ * Подтверждения кумулятивные: успешный ответ на чанк seq означает, что получены все чанки
+ * с номерами <= seq. Ожидающие запросы для таких чанков снимаются сразу, освобождая окно,
+ * даже если сервер на них не ответил. Объект разделяется обработчиками завершения запросов,
+ * поэтому создаётся через std::make_shared.
+ * Окно может быть общим для нескольких одновременно передаваемых файлов.
+ */
+class TransferTracker {
+    std::shared_ptr<InFlightWindow> window_;
+
+    std::mutex mutex_{};
+    std::condition_variable idle_{};
+    std::map<uint64_t, RequestHandle> pending_{};   // Неподтверждённые чанки по seq
+    size_t   outstanding_ = 0;                      // Чанки этого файла, занимающие окно
+    uint64_t acked_ = 0;                            // Все чанки <= acked_ подтверждены
+    bool     error_ = false;                        // Сервер отклонил чанк
+
+public:
+    explicit TransferTracker(size_t window) : window_(std::make_shared<InFlightWindow>(window)) {}
+    explicit TransferTracker(std::shared_ptr<InFlightWindow> window) : window_(std::move(window)) {}
+
+    [[nodiscard]] const std::shared_ptr<InFlightWindow>& window() const { return window_; }
+
+    // Занять место в окне перед отправкой чанка
+    bool acquire(std::chrono::milliseconds timeout) {
+        return window_->acquire_for(timeout);
+    }
+
+    // Чанк будет отправлен (вызывается до отправки, чтобы быстрый ответ не обогнал учёт)
+    void begin(uint64_t seq) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.emplace(seq, RequestHandle{});
+        ++outstanding_;
+    }
+
+    // Запрос чанка создан; false - чанк уже подтверждён кумулятивно и запрос можно снять
+    bool attach(uint64_t seq, RequestHandle request) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pending_.find(seq);
+        if (it == pending_.end()) return false;
+        it->second = std::move(request);
+        return true;
+    }
+
+    /**
+     * @brief Завершение запроса чанка (из обработчика send_async)
+     * @param acked Сервер подтвердил чанк
+     * @param rejected Сервер ответил ошибкой - передачу нужно прервать
+     * @return Запросы чанков, подтверждённых кумулятивно: их нужно снять (RequestManager::cancel)
+     */
+    std::vector<RequestHandle> complete(uint64_t seq, bool acked, bool rejected) {
+        std::vector<RequestHandle> covered;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.erase(seq);
+            if (rejected) {
+                error_ = true;
+            } else if (acked && seq > acked_) {
+                acked_ = seq;
+                for (auto it = pending_.begin(); it != pending_.end() && it->first < seq; ) {
+                    if (it->second) covered.push_back(std::move(it->second));
+                    it = pending_.erase(it);
+                }
+            }
+            if (outstanding_ > 0) --outstanding_;
+        }
+        idle_.notify_all();
+        window_->release();
+        return covered;
+    }
+
+    // Дождаться ответов на все отправленные чанки этого файла
+    bool wait_idle(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return idle_.wait_for(lock, timeout, [this] { return outstanding_ == 0; });
+    }
+
+    [[nodiscard]] bool idle() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return outstanding_ == 0;
+    }
+
+    [[nodiscard]] uint64_t acked() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return acked_;
+    }
+
+    [[nodiscard]] bool failed() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return error_;
+    }
+};
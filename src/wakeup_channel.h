@@ -0,0 +1,65 @@
+#pragma once
+
+#include <zmq.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief Канал пробуждения цикла опроса сокетов (пара ZMQ_PAIR через inproc)
+ *
+ * Принимающий сокет опрашивается циклом вместе с рабочими сокетами, notify() вызывается
+ * из любого потока. Сигнал не несёт данных: проснувшись, цикл сам проверяет флаги состояния
+ * (остановка, новые сокеты, изменения подписки). Повторные сигналы до очередного drain()
+ * схлопываются в один, поэтому канал не переполняется.
+ */
+class WakeupChannel {
+    zmq::socket_t receiver_;
+    zmq::socket_t sender_;
+    std::mutex send_mutex_{};               // Сокет ZeroMQ не потокобезопасен
+    std::atomic<bool> pending_{false};
+
+public:
+    explicit WakeupChannel(zmq::context_t& ctx)
+            : receiver_(ctx, zmq::socket_type::pair),
+              sender_(ctx, zmq::socket_type::pair) {
+        const std::string endpoint = "inproc://wakeup-" + std::to_string(reinterpret_cast<uintptr_t>(this));
+        receiver_.set(zmq::sockopt::linger, 0);
+        sender_.set(zmq::sockopt::linger, 0);
+        receiver_.bind(endpoint);
+        sender_.connect(endpoint);
+    }
+
+    WakeupChannel(const WakeupChannel&) = delete;
+    WakeupChannel& operator=(const WakeupChannel&) = delete;
+
+    // Сокет для опроса (только поток цикла)
+    zmq::socket_t& socket() { return receiver_; }
+
+    void notify() {
+        if (pending_.exchange(true, std::memory_order_acq_rel)) return;   // Сигнал уже в пути
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        if (sender_.handle() == nullptr) return;
+        zmq::message_t signal(0);
+        (void)sender_.send(signal, zmq::send_flags::dontwait);
+    }
+
+    // Вычитать накопившиеся сигналы (только поток цикла, после пробуждения).
+    // Флаг сбрасывается только после опустошения канала: сигнал notify(), пришедшего позже,
+    // останется в канале и разбудит следующий опрос. Обмен (а не запись) флага синхронизирует
+    // с notify(), пропущенными из-за уже поднятого флага: их изменения состояния видны циклу
+    void drain() {
+        zmq::message_t signal;
+        while (receiver_.recv(signal, zmq::recv_flags::dontwait)) {}
+        pending_.exchange(false, std::memory_order_acq_rel);
+    }
+
+    // Закрыть сокеты (до закрытия контекста; поток цикла к этому моменту завершён)
+    void close() {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        if (sender_.handle() != nullptr) sender_.close();
+        if (receiver_.handle() != nullptr) receiver_.close();
+    }
+};
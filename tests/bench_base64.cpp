@@ -0,0 +1,43 @@
+// Замер base64: прежняя реализация против скалярного, SSSE3 и AVX2 путей (доступных
+// на этом процессоре) на буфере 16 МБ (при масштабе 1). Печатается скорость в МБ/с исходных данных.
+
+#include "crc_utils.h"
+#include "legacy_base64.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+
+int main(int argc, char** argv) {
+    const auto size = std::max<size_t>(static_cast<size_t>(16 * 1024 * 1024 * test::scale(argc, argv)), 3) / 3 * 3;
+    std::mt19937_64 rng(1);
+    std::string data(size, '\0');
+    for (auto& c : data) c = static_cast<char>(rng());
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data.data());
+    const double mb = static_cast<double>(size) / (1024.0 * 1024.0);
+
+    std::printf("%-8s %12s %12s\n", "path", "enc MB/s", "dec MB/s");
+
+    std::string text;
+    std::string decoded;
+    const double legacy_enc = test::seconds([&] { text = legacy::base64_encode(bytes, size); });
+    const double legacy_dec = test::seconds([&] { decoded = legacy::base64_decode(text); });
+    CHECK(decoded == data);
+    std::printf("%-8s %12.0f %12.0f\n", "legacy", mb / legacy_enc, mb / legacy_dec);
+
+    using utils::detail::SimdLevel;
+    const struct { const char* name; SimdLevel level; } paths[] = {
+            {"scalar", SimdLevel::None}, {"ssse3", SimdLevel::Ssse3}, {"avx2", SimdLevel::Avx2}};
+    const SimdLevel best = utils::detail::simd_level();
+    for (const auto& path : paths) {
+        if (static_cast<int>(path.level) > static_cast<int>(best)) break;
+        std::string encoded;
+        const double enc = test::seconds([&] { encoded = utils::detail::base64_encode(bytes, size, path.level); });
+        const double dec = test::seconds([&] { decoded = utils::detail::base64_decode(encoded, path.level); });
+        CHECK(encoded == text);
+        CHECK(decoded == data);
+        std::printf("%-8s %12.0f %12.0f\n", path.name, mb / enc, mb / dec);
+    }
+    return test::result("bench_base64");
+}
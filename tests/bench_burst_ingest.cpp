@@ -0,0 +1,60 @@
+// Замер приёма пачки публикаций: listen_loop вычитывает за пробуждение одно сообщение
+// (бюджет 1) или до 256 сообщений. Пока приём клиента приостановлен, StandInServer рассылает
+// 20000 публикаций по одному тегу (при масштабе 1), и они копятся в очередях libzmq; замер
+// длится от возобновления приёма до появления в кэше тегов значения последней публикации.
+// Печатается число публикаций в секунду (лучшее из трёх прогонов).
+
+#include "client_access.h"
+#include "test_util.h"
+
+#include <algorithm>
+
+namespace {
+    // Время приёма count публикаций, накопленных заранее; < 0 - последняя публикация не дошла
+    double ingest_seconds(StandInServer& server, size_t budget, uint64_t count) {
+        TestClient client("test_client", "127.0.0.1");
+        client.set_recv_batch_budget(budget);
+        TestClientAccess access{client};
+        if (!start_client(client, server)) return -1;
+
+        const uint64_t last = server.published() + count;
+        auto paused = access.pause_receive();
+        server.publish(count);
+        while (server.published() < last) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));  // Последние кадры уходят из PUB
+        paused.unlock();
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto deadline = start + std::chrono::seconds(30);
+        Tag tag;
+        while (!access.tags().get(StandInServer::tag_name(0), tag) || tag.value < last) {
+            if (std::chrono::steady_clock::now() >= deadline) return -1;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        client.stop();
+        return sec;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const auto count = std::max<uint64_t>(static_cast<uint64_t>(20000 * test::scale(argc, argv)), 100);
+    StandInServer::Options options;
+    options.tags_per_publication = 1;   // Стоимость приёма, а не разбора публикации
+    StandInServer server(options);
+
+    std::printf("%-8s %12s\n", "budget", "pub/s");
+    double rates[2] = {};
+    const size_t budgets[2] = {1, 256};
+    for (size_t i = 0; i < 2; ++i) {
+        for (int run = 0; run < 3; ++run) {
+            const double sec = ingest_seconds(server, budgets[i], count);
+            CHECK(sec > 0);
+            if (sec > 0) rates[i] = std::max(rates[i], static_cast<double>(count) / sec);
+        }
+        std::printf("%-8zu %12.0f\n", budgets[i], rates[i]);
+    }
+    // Пакетное вычитывание экономит опрос на каждое сообщение
+    CHECK(rates[1] > rates[0] * 1.2);
+    return test::result("bench_burst_ingest");
+}
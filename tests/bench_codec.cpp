@@ -0,0 +1,121 @@
+// Замер Lz4BlockCodec на чанках файла (FILE_CHUNK_SIZE = 63 КБ): степень сжатия и скорость
+// сжатия/распаковки для текста программы, двоичных данных и нулей. При сборке с liblz4
+// (ZMQ_CLIENT_HAVE_LZ4) рядом печатаются те же показатели LZ4_compress_default.
+
+#include "codec.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef ZMQ_CLIENT_HAVE_LZ4
+#include <lz4.h>
+#endif
+
+namespace
+{
+    using Bytes = std::vector<uint8_t>;
+
+    constexpr size_t CHUNK_SIZE = 63 * 1024;
+
+    Bytes text_bytes(size_t size) {
+        static const char* words[] = {"VAR ", "END_VAR\n", "IF ", "THEN\n", "x := x + 1;\n", "MW", "IX0.",
+                                      "FUNCTION_BLOCK ", "(* comment *)\n", "TON(IN := ", "PT := T#100ms);\n"};
+        std::mt19937_64 rng(1);
+        Bytes data;
+        while (data.size() < size) {
+            std::string word = words[rng() % (sizeof(words) / sizeof(words[0]))];
+            if (rng() % 4 == 0) word += std::to_string(rng() % 1000);
+            data.insert(data.end(), word.begin(), word.end());
+        }
+        data.resize(size);
+        return data;
+    }
+
+    // Двоичный образ: случайные байты вперемешку с повторами недавних фрагментов по 8-39 байт
+    Bytes binary_bytes(size_t size) {
+        std::mt19937_64 rng(2);
+        Bytes data;
+        data.reserve(size + 64);
+        while (data.size() < size) {
+            if (data.size() > 4096 && rng() % 2 == 0) {
+                const size_t from = data.size() - 1 - rng() % 4096;
+                const size_t length = 8 + rng() % 32;
+                for (size_t i = 0; i < length; ++i) data.push_back(data[from + i]);
+            } else {
+                for (int i = 0; i < 16; ++i) data.push_back(static_cast<uint8_t>(rng()));
+            }
+        }
+        data.resize(size);
+        return data;
+    }
+
+    struct Result {
+        double ratio;
+        double compress_mbs;
+        double decompress_mbs;
+    };
+
+    template <typename Compress, typename Decompress>
+    Result measure(const Bytes& data, size_t iterations, Compress&& compress, Decompress&& decompress) {
+        Bytes packed(data.size() * 2 + 64);
+        size_t packed_size = 0;
+        const double c = test::seconds([&] {
+            for (size_t i = 0; i < iterations; ++i) packed_size = compress(data, packed);
+        });
+        Bytes restored(data.size());
+        size_t restored_size = 0;
+        const double d = test::seconds([&] {
+            for (size_t i = 0; i < iterations; ++i) restored_size = decompress(packed, packed_size, restored);
+        });
+        CHECK(restored_size == data.size() && restored == data);
+        const double mb = static_cast<double>(data.size() * iterations) / (1024.0 * 1024.0);
+        return {static_cast<double>(packed_size) / static_cast<double>(data.size()), mb / c, mb / d};
+    }
+}
+
+int main(int argc, char** argv) {
+    const auto iterations = std::max<size_t>(static_cast<size_t>(2000 * test::scale(argc, argv)), 1);
+    const Lz4BlockCodec codec;
+
+    struct Sample { const char* name; Bytes data; };
+    const Sample samples[] = {
+            {"text", text_bytes(CHUNK_SIZE)},
+            {"binary", binary_bytes(CHUNK_SIZE)},
+            {"zeros", Bytes(CHUNK_SIZE, 0)},
+    };
+
+    std::printf("%-8s %-8s %8s %12s %12s\n", "data", "codec", "ratio", "comp MB/s", "decomp MB/s");
+    for (const auto& sample : samples) {
+        const Result own = measure(sample.data, iterations,
+                [&](const Bytes& in, Bytes& out) {
+                    return codec.compress(in.data(), in.size(), out.data(), out.size());
+                },
+                [&](const Bytes& in, size_t size, Bytes& out) {
+                    return codec.decompress(in.data(), size, out.data(), out.size());
+                });
+        std::printf("%-8s %-8s %8.3f %12.0f %12.0f\n", sample.name, "builtin", own.ratio,
+                    own.compress_mbs, own.decompress_mbs);
+        // Сжатие должно окупаться на тексте программы - основном содержимом загрузок
+        if (&sample == &samples[0]) CHECK(own.ratio < 0.5);
+
+#ifdef ZMQ_CLIENT_HAVE_LZ4
+        const Result lib = measure(sample.data, iterations,
+                [](const Bytes& in, Bytes& out) {
+                    return static_cast<size_t>(LZ4_compress_default(reinterpret_cast<const char*>(in.data()),
+                            reinterpret_cast<char*>(out.data()), static_cast<int>(in.size()), static_cast<int>(out.size())));
+                },
+                [](const Bytes& in, size_t size, Bytes& out) {
+                    return static_cast<size_t>(LZ4_decompress_safe(reinterpret_cast<const char*>(in.data()),
+                            reinterpret_cast<char*>(out.data()), static_cast<int>(size), static_cast<int>(out.size())));
+                });
+        std::printf("%-8s %-8s %8.3f %12.0f %12.0f\n", sample.name, "liblz4", lib.ratio,
+                    lib.compress_mbs, lib.decompress_mbs);
+        // Жадный поиск по одной хеш-таблице уступает liblz4 в степени сжатия, но не кратно
+        CHECK(own.ratio < lib.ratio * 1.5 + 0.01);
+#endif
+    }
+    return test::result("bench_codec");
+}
@@ -0,0 +1,68 @@
+// Замер передачи файла со сжатием и без него через узкий канал: StandInServer пропускает
+// 20 МБ/с к серверу (bandwidth) с задержкой ответа 1 мс, выбирает "lz4" из кодеков file_start
+// и распаковывает чанки. Файл - 16 МБ текста программы (при масштабе 1), окно 16 чанков.
+// Печатаются байты данных чанков в канале, время передачи и эффективная скорость.
+
+#include "client_access.h"
+#include "test_util.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace
+{
+    std::string program_text(size_t size) {
+        static const char* words[] = {"VAR ", "END_VAR\n", "IF ", "THEN\n", "x := x + 1;\n", "MW", "IX0.",
+                                      "FUNCTION_BLOCK ", "(* comment *)\n", "TON(IN := ", "PT := T#100ms);\n"};
+        std::mt19937_64 rng(1);
+        std::string data;
+        while (data.size() < size) {
+            data += words[rng() % (sizeof(words) / sizeof(words[0]))];
+            if (rng() % 4 == 0) data += std::to_string(rng() % 1000);
+        }
+        data.resize(size);
+        return data;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const auto size = std::max<size_t>(static_cast<size_t>(16 * 1024 * 1024 * test::scale(argc, argv)), 1024);
+    const auto path = std::filesystem::temp_directory_path() / "zmq_client_bench_compressed_transfer.txt";
+    const std::string data = program_text(size);
+    std::ofstream(path, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+    const double mb = static_cast<double>(size) / (1024.0 * 1024.0);
+    const uint32_t expected_crc = utils::calculate_crc32(data.data(), data.size());
+
+    StandInServer::Options options;
+    options.latency = std::chrono::milliseconds(1);
+    options.bandwidth = 20 * 1024 * 1024;
+    options.codec = "lz4";
+    StandInServer server(options);
+    TestClient client("test_client", "127.0.0.1");
+    TestClientAccess access{client};
+    CHECK(start_client(client, server));
+
+    std::printf("%-12s %14s %10s %10s\n", "mode", "wire bytes", "sec", "MB/s");
+    uint64_t wire[2] = {};
+    double secs[2] = {};
+    const char* modes[2] = {"plain", "lz4"};
+    for (size_t i = 0; i < 2; ++i) {
+        const uint64_t before = server.chunk_bytes();
+        uint32_t crc = 0;
+        secs[i] = test::seconds([&] { crc = access.send_file(path.string(), 16, i == 1); });
+        wire[i] = server.chunk_bytes() - before;
+        CHECK(crc == expected_crc);
+        CHECK(server.file(path.filename().string()) == data);
+        std::printf("%-12s %14llu %10.3f %10.1f\n", modes[i], static_cast<unsigned long long>(wire[i]),
+                    secs[i], mb / secs[i]);
+    }
+    CHECK(wire[0] == size);
+    // Сжатие уменьшает объём в канале и, когда узкое место - канал, время передачи
+    CHECK(wire[1] < wire[0] / 2);
+    CHECK(secs[1] < secs[0]);
+
+    client.stop();
+    std::filesystem::remove(path);
+    return test::result("bench_compressed_transfer");
+}
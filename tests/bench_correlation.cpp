@@ -0,0 +1,110 @@
+// Замер конкуренции за таблицу ожидающих запросов: прежний RequestManager
+// (общий мьютекс + unordered_map по строке "key:request" + make_shared на запрос)
+// против RequestManager на CorrelationTable при 1, 8 и 64 потоках.
+// Каждая операция - создание запроса и доставка ответа на него, как при синхронном вызове.
+
+#include "request_manager.h"
+#include "test_util.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace legacy
+{
+    // Реализация до перехода на CorrelationTable (для сравнения)
+    class SyncRequest {
+        std::mutex mutex_{};
+        std::condition_variable cv_{};
+        Response response_ = Response::success("key", "action");
+        bool ready_ = false;
+
+    public:
+        void set_response(const Response& response) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            response_ = response;
+            ready_ = true;
+            cv_.notify_one();
+        }
+    };
+
+    class RequestManager {
+        std::mutex mutex_;
+        std::unordered_map<std::string, std::shared_ptr<SyncRequest>> requests_;
+
+    public:
+        std::shared_ptr<SyncRequest> create(const std::string& key, const std::string& request) {
+            auto req = std::make_shared<SyncRequest>();
+            std::lock_guard<std::mutex> lock(mutex_);
+            requests_[key + ":" + request] = req;
+            return req;
+        }
+
+        bool process_response(const Response& response) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto key = response.key + ":" + response.request;
+            if (auto it = requests_.find(key); it != requests_.end()) {
+                it->second->set_response(response);
+                requests_.erase(it);
+                return true;
+            }
+            return false;
+        }
+    };
+} // namespace legacy
+
+// Операций в секунду на всех потоках; body(thread_index, iterations) возвращает число успешных
+template <typename Body>
+double run(size_t threads, size_t iterations, Body body) {
+    std::vector<std::thread> workers;
+    std::vector<size_t> matched(threads, 0);
+    const double elapsed = test::seconds([&] {
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] { matched[t] = body(t, iterations); });
+        }
+        for (auto& worker : workers) worker.join();
+    });
+    for (size_t count : matched) CHECK(count == iterations);
+    return static_cast<double>(threads * iterations) / elapsed;
+}
+
+int main(int argc, char** argv) {
+    const auto total = static_cast<size_t>(640000 * test::scale(argc, argv));
+
+    std::printf("%8s %16s %16s %8s\n", "threads", "legacy ops/s", "table ops/s", "speedup");
+    for (size_t threads : {1, 8, 64}) {
+        const size_t iterations = std::max<size_t>(total / threads, 1);
+
+        legacy::RequestManager old_manager;
+        const double old_rate = run(threads, iterations, [&](size_t t, size_t n) {
+            const std::string key = "client-" + std::to_string(t);
+            const Response response = Response::success(key, "read_tag");
+            size_t ok = 0;
+            for (size_t i = 0; i < n; ++i) {
+                auto req = old_manager.create(key, "read_tag");
+                ok += old_manager.process_response(response);
+            }
+            return ok;
+        });
+
+        RequestManager manager;
+        const double new_rate = run(threads, iterations, [&](size_t t, size_t n) {
+            const std::string key = "client-" + std::to_string(t);
+            Response response = Response::success(key, "read_tag");
+            size_t ok = 0;
+            for (size_t i = 0; i < n; ++i) {
+                auto req = manager.create(key, "read_tag");
+                response.id = req->id();
+                ok += manager.process_response(response);
+            }
+            return ok;
+        });
+
+        std::printf("%8zu %16.0f %16.0f %7.2fx\n", threads, old_rate, new_rate, new_rate / old_rate);
+    }
+    return test::result("bench_correlation");
+}
@@ -0,0 +1,40 @@
+// Замер CRC32 на буфере 64 МБ (при масштабе 1): побайтовый расчёт по таблице (прежняя
+// реализация), slice-by-16 и свёртка PCLMULQDQ (если поддерживается процессором).
+// Печатается скорость в МБ/с.
+
+#include "crc_utils.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+int main(int argc, char** argv) {
+    const auto size = std::max<size_t>(static_cast<size_t>(64 * 1024 * 1024 * test::scale(argc, argv)), 64) / 16 * 16;
+    std::mt19937_64 rng(1);
+    std::vector<uint8_t> data(size);
+    for (auto& b : data) b = static_cast<uint8_t>(rng());
+    const double mb = static_cast<double>(size) / (1024.0 * 1024.0);
+
+    std::printf("%-10s %12s\n", "path", "MB/s");
+    uint32_t bytewise = 0;
+    const double base = test::seconds([&] { bytewise = utils::detail::crc32_bytewise(~0u, data.data(), size); });
+    std::printf("%-10s %12.0f\n", "bytewise", mb / base);
+
+    uint32_t slice = 0;
+    const double sliced = test::seconds([&] { slice = utils::detail::crc32_slice16(~0u, data.data(), size); });
+    CHECK(slice == bytewise);
+    std::printf("%-10s %12.0f\n", "slice16", mb / sliced);
+    CHECK(sliced < base);
+
+#ifdef UTILS_CRC32_PCLMUL
+    if (utils::detail::has_pclmul()) {
+        uint32_t folded = 0;
+        const double sec = test::seconds([&] { folded = utils::detail::crc32_pclmul(~0u, data.data(), size); });
+        CHECK(folded == bytewise);
+        std::printf("%-10s %12.0f\n", "pclmul", mb / sec);
+        CHECK(sec < sliced);
+    }
+#endif
+    return test::result("bench_crc32");
+}
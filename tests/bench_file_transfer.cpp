@@ -0,0 +1,46 @@
+// Замер передачи файла против локального StandInServer: окно в 1 чанк (ожидание подтверждения
+// каждого чанка) против окна в 16 чанков. Сервер задерживает каждый ответ на 2 мс, файл - 16 МБ
+// случайных данных (при масштабе 1), сжатие выключено. Печатается скорость в МБ/с.
+
+#include "client_access.h"
+#include "test_util.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+int main(int argc, char** argv) {
+    const auto size = std::max<size_t>(static_cast<size_t>(16 * 1024 * 1024 * test::scale(argc, argv)), 1024);
+    const auto path = std::filesystem::temp_directory_path() / "zmq_client_bench_file_transfer.bin";
+    {
+        std::mt19937_64 rng(1);
+        std::string data(size, '\0');
+        for (auto& c : data) c = static_cast<char>(rng());
+        std::ofstream(path, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+    const double mb = static_cast<double>(size) / (1024.0 * 1024.0);
+
+    StandInServer::Options options;
+    options.latency = std::chrono::milliseconds(2);
+    StandInServer server(options);
+    TestClient client("test_client", "127.0.0.1");
+    TestClientAccess access{client};
+    CHECK(start_client(client, server));
+
+    std::printf("%-10s %12s\n", "window", "MB/s");
+    double rates[2] = {};
+    const size_t windows[2] = {1, 16};
+    for (size_t i = 0; i < 2; ++i) {
+        const uint64_t before = server.chunk_bytes();
+        const double sec = test::seconds([&] { access.send_file(path.string(), windows[i]); });
+        CHECK(server.chunk_bytes() - before == size);
+        rates[i] = mb / sec;
+        std::printf("%-10zu %12.1f\n", windows[i], rates[i]);
+    }
+    // Окно перекрывает задержку подтверждений
+    CHECK(rates[1] > rates[0]);
+
+    client.stop();
+    std::filesystem::remove(path);
+    return test::result("bench_file_transfer");
+}
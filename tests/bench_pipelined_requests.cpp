@@ -0,0 +1,70 @@
+// Замер ADM-запросов против локального StandInServer: синхронные запросы по одному против
+// конвейерной отправки (send_async) с окнами 16 и 256. Сервер задерживает каждый ответ на 1 мс,
+// так что синхронный режим ограничен задержкой канала. Печатается число запросов в секунду.
+
+#include "client_access.h"
+#include "test_util.h"
+
+#include <algorithm>
+
+namespace {
+    json ping() { return { {"key", "test_client"}, {"request", "ping"} }; }
+
+    double sync_rate(TestClientAccess& access, size_t count) {
+        size_t ok = 0;
+        const double sec = test::seconds([&] {
+            for (size_t i = 0; i < count; ++i) {
+                Response response;
+                if (access.request(ping(), std::chrono::seconds(3), response) && response.isSuccess()) ++ok;
+            }
+        });
+        CHECK(ok == count);
+        return static_cast<double>(count) / sec;
+    }
+
+    double pipelined_rate(TestClient& client, TestClientAccess& access, size_t count, size_t window) {
+        client.set_async_window(window);
+        size_t ok = 0;
+        std::vector<RequestHandle> handles;
+        handles.reserve(count);
+        const double sec = test::seconds([&] {
+            for (size_t i = 0; i < count; ++i) {
+                handles.push_back(access.request_async(ping(), std::chrono::seconds(3)));
+            }
+            Response response;
+            for (auto& handle : handles) {
+                if (handle && handle->wait(response, std::chrono::seconds(3)) && response.isSuccess()) ++ok;
+            }
+        });
+        CHECK(ok == count);
+        return static_cast<double>(count) / sec;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const auto count = std::max<size_t>(static_cast<size_t>(2000 * test::scale(argc, argv)), 10);
+
+    StandInServer::Options options;
+    options.latency = std::chrono::milliseconds(1);
+    StandInServer server(options);
+    TestClient client("test_client", "127.0.0.1");
+    TestClientAccess access{client};
+    CHECK(start_client(client, server));
+
+    std::printf("%-12s %12s\n", "mode", "req/s");
+    const double sync = sync_rate(access, count);
+    std::printf("%-12s %12.0f\n", "sync", sync);
+    for (size_t window : {16, 256}) {
+        const double rate = pipelined_rate(client, access, count, window);
+        std::printf("window %-5zu %12.0f\n", window, rate);
+        // Даже малое окно перекрывает задержку ответа сервера
+        CHECK(rate > sync);
+    }
+
+    // Окно не может превышать ёмкость таблицы ожидающих запросов
+    client.set_async_window(RequestManager::POOL_CAPACITY * 4);
+    CHECK(access.async_window() == RequestManager::POOL_CAPACITY);
+
+    client.stop();
+    return test::result("bench_pipelined_requests");
+}
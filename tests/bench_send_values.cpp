@@ -0,0 +1,71 @@
+// Замер кодирования и разбора SendValues: JSON против двоичного формата
+// для сообщений из 10, 1000 и 100000 тегов. Двоичный кодек замеряется с прогретым
+// словарём (имена тегов уже переданы), как в установившемся потоке публикаций.
+// Печатается время на сообщение и размер кадра; результаты обоих разборов сверяются.
+
+#include "dto.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace
+{
+    std::vector<Tag> make_tags(size_t count) {
+        std::vector<Tag> tags(count);
+        const auto now = std::chrono::time_point_cast<std::chrono::milliseconds>(sysclk::now());
+        for (size_t i = 0; i < count; ++i) {
+            tags[i].key = "%ID" + std::to_string(100000 + i);
+            tags[i].value = i * 2654435761ULL;
+            tags[i].quality = Quality::GOOD;
+            tags[i].timestamp = now + std::chrono::milliseconds(i);
+        }
+        return tags;
+    }
+
+    // Микросекунды на одну итерацию body
+    template <typename F>
+    double per_message_us(size_t iterations, F&& body) {
+        const double elapsed = test::seconds([&] {
+            for (size_t i = 0; i < iterations; ++i) body();
+        });
+        return elapsed * 1e6 / static_cast<double>(iterations);
+    }
+}
+
+int main(int argc, char** argv) {
+    const double scale = test::scale(argc, argv);
+
+    std::printf("%8s %10s %12s %12s %10s %12s %12s %8s\n", "tags", "json B", "json enc us", "json dec us",
+                "bin B", "bin enc us", "bin dec us", "speedup");
+    for (size_t count : {10, 1000, 100000}) {
+        // Одинаковый объём работы для всех размеров сообщений: около 2 млн тегов при scale = 1
+        const auto iterations = std::max<size_t>(static_cast<size_t>(2000000 * scale / count), 1);
+        const SendValues message{"client-1", "default", make_tags(count)};
+
+        std::string text;
+        const double json_enc = per_message_us(iterations, [&] { text = message.toJSON(); });
+        SendValues from_json{"", "", {}};
+        const double json_dec = per_message_us(iterations, [&] { from_json = SendValues::fromJSON(text); });
+
+        TagDictionary sender, receiver;
+        std::string frame = message.toBinary(sender);
+        (void)SendValues::fromBinary(frame.data(), frame.size(), receiver);   // Имена переданы
+
+        const double bin_enc = per_message_us(iterations, [&] { frame = message.toBinary(sender); });
+        SendValues from_binary{"", "", {}};
+        const double bin_dec = per_message_us(iterations, [&] {
+            from_binary = SendValues::fromBinary(frame.data(), frame.size(), receiver);
+        });
+
+        CHECK(from_json.values.size() == count);
+        CHECK(from_binary.values.size() == count);
+        CHECK(from_binary.values.back().key == message.values.back().key);
+        CHECK(from_binary.values.back().value == from_json.values.back().value);
+
+        std::printf("%8zu %10zu %12.2f %12.2f %10zu %12.2f %12.2f %7.2fx\n", count, text.size(), json_enc,
+                    json_dec, frame.size(), bin_enc, bin_dec, (json_enc + json_dec) / (bin_enc + bin_dec));
+    }
+    return test::result("bench_send_values");
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+// Клиент целиком (без его main) и доступ к внутренним операциям для сетевых тестов
+#define ZMQ_CLIENT_NO_MAIN
+#include "test_client.cpp"
+
+#include "stand_in_server.h"
+
+struct TestClientAccess {
+    static constexpr size_t FILE_CHUNK_SIZE = TestClient::FILE_CHUNK_SIZE;
+
+    TestClient& client;
+
+    bool connected() const { return client.connection_ok_; }
+
+    // Синхронный запрос: ответ (или ошибка) через response
+    bool request(json message, std::chrono::milliseconds timeout, Response& response) {
+        return client.send_message(std::move(message), TestClient::RequestMode::Sync, timeout, &response);
+    }
+
+    RequestHandle request_async(json message, std::chrono::milliseconds timeout, SyncRequest::Callback on_complete = {}) {
+        return client.send_async(std::move(message), timeout, std::move(on_complete));
+    }
+
+    size_t async_window() { return client.async_window_.limit(); }
+
+    bool heartbeat() { return client.send_heartbeat(); }
+
+    void subscribe(const std::string& topic) { client.subscribe_topic(topic); }
+
+    TagStore& tags() { return client.tag_store_; }
+
+    // Приостановить приём: listen_loop останавливается на применении изменений подписки,
+    // пока возвращённая блокировка не снята. Пришедшие сообщения копятся в очередях libzmq
+    std::unique_lock<std::mutex> pause_receive() {
+        std::unique_lock<std::mutex> lock(client.topics_mutex_);
+        client.topics_dirty_ = true;
+        client.wakeup_.notify();
+        return lock;
+    }
+
+    // Передача файла окном window чанков, по умолчанию без сжатия (данные замеров случайны);
+    // возвращает CRC32, рассчитанный клиентом по ходу передачи
+    uint32_t send_file(const std::string& path, size_t window, bool compress = false) {
+        client.transfer_window_ = window;
+        client.compress_files_ = compress;
+        return client.send_file(utils::MappedFile::open(path));
+    }
+};
+
+// Запуск клиента против StandInServer и ожидание подписки (SUB подключается не мгновенно)
+inline bool start_client(TestClient& client, StandInServer& server, std::chrono::seconds timeout = std::chrono::seconds(10)) {
+    client.start();
+    TestClientAccess access{client};
+    access.subscribe("default");
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    Tag tag;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (access.connected() && access.tags().get(StandInServer::tag_name(0), tag)) return true;
+        server.publish(1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    return false;
+}
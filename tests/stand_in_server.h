@@ -0,0 +1,339 @@
+#pragma once
+
+#include "codec.h"
+#include "crc_utils.h"
+#include "dto.h"
+
+#include <zmq.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Локальная замена сервера для сетевых тестов и замеров клиента
+ *
+ * ROUTER на :5551 отвечает на ADM-запросы (connect, heartbeat, file_*, prog_* и любые другие -
+ * успехом), PUB на :5552 рассылает публикации SendValues с кадром топика: JSON либо (binary,
+ * если клиент предложил его в pub_formats) двоичные с общим для всех подписчиков словарём тегов.
+ * Ответы можно задерживать на latency (имитация задержки канала), а приём запросов - ограничивать
+ * пропускной способностью bandwidth: ответ уходит не раньше, чем запрос прошёл бы через канал
+ * такой ширины. Все сокеты принадлежат
+ * одному потоку сервера; публикации заказываются через publish() или flood().
+ *
+ * Из кодеков, предложенных в file_start, сервер выбирает codec (если он есть среди предложенных)
+ * и распаковывает им сжатые чанки. Чанки файлов собираются по offset: подтверждённое смещение растёт только подряд, чанк
+ * за разрывом отклоняется, file_status отвечает подтверждённым смещением. drop_after_bytes
+ * однократно обрывает связь посреди передачи: ROUTER закрывается вместе с непрочитанными
+ * запросами и неотправленными ответами и через drop_for открывается заново.
+ */
+class StandInServer {
+public:
+    struct Options {
+        std::chrono::microseconds latency{0};    // Задержка каждого ответа ADM
+        uint64_t bandwidth = 0;                  // Пропускная способность канала к серверу, байт/с (0 - без ограничения)
+        std::string codec;                       // Кодек сжатия чанков, выбираемый в file_start (пусто - без сжатия)
+        bool topic_frame = true;                 // Подтверждать pub_topic_frame в ответе на connect
+        bool raw_chunks = true;                  // Подтверждать file_chunk_payload = "frame"
+        std::string client_key = "test_client";  // Получатель публикаций
+        size_t tags_per_publication = 16;
+        bool binary = false;                     // Двоичные публикации, если клиент их поддерживает
+        uint64_t drop_after_bytes = 0;           // Оборвать связь, получив столько байт чанков (0 - нет)
+        std::chrono::milliseconds drop_for{1000};    // Длительность обрыва
+    };
+
+    StandInServer() : StandInServer(Options()) {}
+
+    explicit StandInServer(Options options) : options_(std::move(options)) {
+        open_router();
+        pub_.set(zmq::sockopt::linger, 0);
+        pub_.set(zmq::sockopt::sndhwm, 0);
+        pub_.bind("tcp://127.0.0.1:5552");
+        thread_ = std::thread(&StandInServer::run, this);
+    }
+
+    StandInServer(const StandInServer&) = delete;
+    StandInServer& operator=(const StandInServer&) = delete;
+
+    ~StandInServer() {
+        running_ = false;
+        thread_.join();
+        router_.close();
+        pub_.close();
+    }
+
+    // Разослать count публикаций (номера продолжают общую нумерацию, см. published())
+    void publish(uint64_t count) { to_publish_ += count; }
+
+    // Непрерывная рассылка публикаций с максимальной скоростью
+    void flood(bool on) { flood_ = on; }
+
+    [[nodiscard]] uint64_t published() const { return published_; }
+    [[nodiscard]] uint64_t requests() const { return requests_; }
+    [[nodiscard]] uint64_t heartbeats() const { return heartbeats_; }
+    [[nodiscard]] uint64_t chunk_bytes() const { return chunk_bytes_; }  // Данные чанков в канале (сжатые)
+    [[nodiscard]] uint64_t drops() const { return drops_; }
+    [[nodiscard]] uint64_t binary_published() const { return binary_published_; }
+
+    // Собранное содержимое файла (до подтверждённого смещения)
+    [[nodiscard]] std::string file(const std::string& name) const {
+        std::lock_guard<std::mutex> lock(files_mutex_);
+        auto it = files_.find(name);
+        return it == files_.end() ? std::string{} : it->second.data.substr(0, it->second.committed);
+    }
+
+    // Смещения, которыми сервер ответил на file_status
+    [[nodiscard]] std::vector<uint64_t> status_offsets() const {
+        std::lock_guard<std::mutex> lock(files_mutex_);
+        return status_offsets_;
+    }
+
+    // Смещения первых чанков, пришедших после каждого file_status
+    [[nodiscard]] std::vector<uint64_t> resumed_offsets() const {
+        std::lock_guard<std::mutex> lock(files_mutex_);
+        return resumed_offsets_;
+    }
+
+    // Имя тега публикации: значение тега - номер публикации
+    static std::string tag_name(size_t index) { return "%PUB" + std::to_string(index); }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct Reply {
+        clock::time_point due;
+        std::string identity;
+        std::string body;
+    };
+
+    struct File {
+        std::string data;
+        uint64_t committed = 0;     // Получено подряд с начала файла
+    };
+
+    void open_router() {
+        router_ = zmq::socket_t(ctx_, zmq::socket_type::router);
+        router_.set(zmq::sockopt::linger, 0);
+        router_.set(zmq::sockopt::sndhwm, 0);
+        router_.set(zmq::sockopt::rcvhwm, 0);
+        router_.set(zmq::sockopt::router_handover, 1);   // Клиент с тем же id в следующем замере
+        // После обрыва порт освобождается не мгновенно
+        for (int attempt = 0; ; ++attempt) {
+            try {
+                router_.bind("tcp://127.0.0.1:5551");
+                return;
+            } catch (const zmq::error_t&) {
+                if (attempt >= 50) throw;
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        }
+    }
+
+    void drop_connection() {
+        drop_ = false;
+        ++drops_;
+        replies_.clear();
+        router_.close();
+        std::this_thread::sleep_for(options_.drop_for);
+        open_router();
+    }
+
+    void run() {
+        while (running_) {
+            const bool publishing = flood_ || to_publish_ > 0;
+            auto timeout = std::chrono::milliseconds(publishing ? 0 : 20);
+            if (!replies_.empty()) {
+                const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(replies_.front().due - clock::now());
+                timeout = std::clamp(wait, std::chrono::milliseconds(0), timeout);
+            }
+            zmq::pollitem_t item{router_.handle(), 0, ZMQ_POLLIN, 0};
+            zmq::poll(&item, 1, timeout);
+
+            // Сервер успевает за клиентом: за проход - все запросы, пакет публикаций
+            while (!drop_ && receive_request()) {}
+            if (drop_) drop_connection();
+            send_due_replies();
+            for (int i = 0; i < 64 && (flood_ || to_publish_ > 0); ++i) {
+                if (!flood_) --to_publish_;
+                send_publication();
+            }
+        }
+    }
+
+    bool receive_request() {
+        std::vector<zmq::message_t> frames;
+        zmq::message_t frame;
+        if (!router_.recv(frame, zmq::recv_flags::dontwait)) return false;
+        frames.push_back(std::move(frame));
+        while (frames.back().more()) {
+            (void)router_.recv(frame);
+            frames.push_back(std::move(frame));
+        }
+        if (frames.size() < 2) return true;
+        ++requests_;
+
+        // Запрос занимает канал на время передачи его кадров
+        auto due = clock::now();
+        if (options_.bandwidth != 0) {
+            size_t wire = 0;
+            for (const auto& f : frames) wire += f.size();
+            link_free_ = std::max(link_free_, due) + std::chrono::duration_cast<clock::duration>(
+                    std::chrono::duration<double>(static_cast<double>(wire) / static_cast<double>(options_.bandwidth)));
+            due = link_free_;
+        }
+        due += options_.latency;
+
+        json request = json::parse(frames[1].to_string_view(), nullptr, false);
+        if (!request.is_object()) return true;
+        const std::string name = request.value("request", std::string{});
+        Response response = Response::success(request.value("key", std::string{}), name);
+        response.id = request.value("id", uint64_t{0});
+
+        if (name == "connect") {
+            response.data = json::object();
+            if (options_.topic_frame) response.data["pub_topic_frame"] = true;
+            const auto formats = request.value("pub_formats", std::vector<std::string>{});
+            binary_ = options_.binary && std::find(formats.begin(), formats.end(), "binary") != formats.end();
+            response.data["file_chunk_payload"] = options_.raw_chunks ? FileChunk::RAW_PAYLOAD : "base64";
+        } else if (name == "heartbeat") {
+            ++heartbeats_;
+        } else if (name == "file_start") {
+            std::lock_guard<std::mutex> lock(files_mutex_);
+            const auto file_name = request.value("file_name", std::string{});
+            files_[file_name] = File{std::string(request.value("file_size", uint64_t{0}), '\0')};
+            streams_[request.value("stream", uint32_t{0})] = file_name;
+            const auto offered = request.value("codecs", std::vector<std::string>{});
+            if (!options_.codec.empty() && std::find(offered.begin(), offered.end(), options_.codec) != offered.end()) {
+                response.data = {{"codec", options_.codec}};
+            }
+        } else if (name == "file_chunk") {
+            std::string payload = frames.size() > 2 ? frames[2].to_string()
+                                                    : utils::base64_decode(request.value("chunk_data", std::string{}));
+            chunk_bytes_ += payload.size();
+            if (options_.drop_after_bytes != 0 && drops_ == 0 && chunk_bytes_ >= options_.drop_after_bytes) {
+                drop_ = true;   // Чанк теряется вместе со всем, что не успело прийти
+                return false;
+            }
+            const std::string codec = request.value("codec", std::string{});
+            if (!codec.empty() && !unpack_chunk(codec, request.value("chunk_size", uint64_t{0}), payload)) {
+                response = Response::error(response.key, name, "Cannot decompress chunk");
+                response.id = request.value("id", uint64_t{0});
+            } else if (!store_chunk(request, payload)) {
+                response = Response::error(response.key, name, "Chunk beyond committed offset");
+                response.id = request.value("id", uint64_t{0});
+            }
+        } else if (name == "file_status") {
+            std::lock_guard<std::mutex> lock(files_mutex_);
+            auto it = files_.find(request.value("file_name", std::string{}));
+            if (it == files_.end()) {
+                response = Response::error(response.key, name, "Unknown file");
+                response.id = request.value("id", uint64_t{0});
+            } else {
+                response.data = {{"offset", it->second.committed}};
+                status_offsets_.push_back(it->second.committed);
+                resume_pending_ = true;
+            }
+        }
+
+        replies_.push_back({due, frames[0].to_string(), response.toJSON()});
+        return true;
+    }
+
+    // Распаковка данных чанка до исходного размера size
+    bool unpack_chunk(const std::string& name, uint64_t size, std::string& payload) const {
+        const Codec* codec = codecs_.find(name);
+        if (!codec) return false;
+        std::string unpacked(size, '\0');
+        if (codec->decompress(reinterpret_cast<const uint8_t*>(payload.data()), payload.size(),
+                              reinterpret_cast<uint8_t*>(unpacked.data()), unpacked.size()) != size) {
+            return false;
+        }
+        payload = std::move(unpacked);
+        return true;
+    }
+
+    // Запись чанка по его смещению; false - чанк за разрывом (предыдущие потеряны)
+    bool store_chunk(const json& request, const std::string& payload) {
+        std::lock_guard<std::mutex> lock(files_mutex_);
+        auto stream = streams_.find(request.value("stream", uint32_t{0}));
+        if (stream == streams_.end()) return true;
+        File& file = files_[stream->second];
+        const uint64_t offset = request.value("offset", file.committed);
+        if (resume_pending_) {
+            resumed_offsets_.push_back(offset);
+            resume_pending_ = false;
+        }
+        // Дельта-передача пропускает имеющиеся у сервера блоки - разрыв там ожидаем
+        if (offset > file.committed && !request.contains("block")) return false;
+        if (offset < file.data.size()) {
+            const size_t length = std::min<size_t>(payload.size(), file.data.size() - offset);
+            file.data.replace(offset, length, payload, 0, length);
+        }
+        file.committed = std::max<uint64_t>(file.committed, offset + payload.size());
+        return true;
+    }
+
+    void send_due_replies() {
+        const auto now = clock::now();
+        while (!replies_.empty() && replies_.front().due <= now) {
+            Reply& reply = replies_.front();
+            zmq::message_t identity(reply.identity);
+            zmq::message_t body(reply.body);
+            (void)router_.send(identity, zmq::send_flags::sndmore);
+            (void)router_.send(body, zmq::send_flags::none);
+            replies_.pop_front();
+        }
+    }
+
+    void send_publication() {
+        const uint64_t number = ++published_;
+        std::vector<Tag> tags(options_.tags_per_publication);
+        for (size_t i = 0; i < tags.size(); ++i) {
+            tags[i].key = tag_name(i);
+            tags[i].value = number;
+            tags[i].quality = Quality::GOOD;
+            tags[i].timestamp = sysclk::now();
+        }
+        zmq::message_t topic(SendValues::topicFrame(options_.client_key, "default"));
+        const SendValues values{options_.client_key, "default", std::move(tags)};
+        // Словарь не сбрасывается при connect: имена доходят до подписчика повторами
+        zmq::message_t body(binary_ ? values.toBinary(dictionary_) : values.toJSON());
+        if (binary_) ++binary_published_;
+        (void)pub_.send(topic, zmq::send_flags::sndmore);
+        (void)pub_.send(body, zmq::send_flags::none);
+    }
+
+    Options options_;
+    zmq::context_t ctx_{1};
+    zmq::socket_t router_{};
+    zmq::socket_t pub_{ctx_, zmq::socket_type::pub};
+    std::thread thread_{};
+    std::atomic<bool> running_{true};
+    std::atomic<bool> flood_{false};
+    std::atomic<uint64_t> to_publish_{0};
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> heartbeats_{0};
+    std::atomic<uint64_t> chunk_bytes_{0};
+    std::atomic<uint64_t> drops_{0};
+    std::atomic<uint64_t> binary_published_{0};
+    bool drop_ = false;
+    bool binary_ = false;
+    TagDictionary dictionary_{};
+    std::deque<Reply> replies_{};
+    clock::time_point link_free_{};         // Канал к серверу занят до этого момента
+    CodecRegistry codecs_{};
+    mutable std::mutex files_mutex_;
+    std::map<std::string, File> files_{};
+    std::map<uint32_t, std::string> streams_{};
+    std::vector<uint64_t> status_offsets_{};
+    std::vector<uint64_t> resumed_offsets_{};
+    bool resume_pending_ = false;
+};
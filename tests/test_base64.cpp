@@ -0,0 +1,108 @@
+// base64: векторные пути (AVX2, SSSE3) и скалярный дают тот же результат, что и прежняя
+// реализация - для всех длин хвоста, на границах векторных блоков и на некорректном входе
+// ('=' и символы вне алфавита в любой позиции, байты старше 0x7F, отсутствие дополнения).
+
+#include "crc_utils.h"
+#include "legacy_base64.h"
+#include "test_util.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using utils::detail::SimdLevel;
+
+    std::string random_bytes(size_t size, std::mt19937_64& rng) {
+        std::string data(size, '\0');
+        for (auto& c : data) c = static_cast<char>(rng());
+        return data;
+    }
+
+    // Все пути, доступные на этом процессоре
+    std::vector<SimdLevel> levels() {
+        std::vector<SimdLevel> result{SimdLevel::None};
+        const SimdLevel best = utils::detail::simd_level();
+        if (best == SimdLevel::Ssse3 || best == SimdLevel::Avx2) result.push_back(SimdLevel::Ssse3);
+        if (best == SimdLevel::Avx2) result.push_back(SimdLevel::Avx2);
+        return result;
+    }
+
+    std::string encode(const std::string& data, SimdLevel level) {
+        return utils::detail::base64_encode(reinterpret_cast<const unsigned char*>(data.data()), data.size(), level);
+    }
+
+    std::string legacy_encode(const std::string& data) {
+        return legacy::base64_encode(reinterpret_cast<const unsigned char*>(data.data()), data.size());
+    }
+
+    bool same_decode(const std::string& text, SimdLevel level) {
+        return utils::detail::base64_decode(text, level) == legacy::base64_decode(text);
+    }
+}
+
+int main() {
+    std::mt19937_64 rng(2025);
+    const auto all = levels();
+    std::printf("base64 paths checked: %zu (best: %d)\n", all.size(), static_cast<int>(utils::detail::simd_level()));
+
+    // Все длины до нескольких векторных блоков AVX2 (24 байта -> 32 символа) и их хвосты
+    for (size_t size = 0; size <= 400; ++size) {
+        const std::string data = random_bytes(size, rng);
+        const std::string expected = legacy_encode(data);
+        for (SimdLevel level : all) {
+            const std::string text = encode(data, level);
+            CHECK(text == expected);
+            CHECK(utils::detail::base64_decode(text, level) == data);
+            CHECK(same_decode(text, level));
+
+            // Без дополнения '=' и с отрезанным концом (неполная последняя четвёрка)
+            std::string unpadded = text;
+            while (!unpadded.empty() && unpadded.back() == '=') unpadded.pop_back();
+            CHECK(utils::detail::base64_decode(unpadded, level) == data);
+            for (size_t cut = 1; cut <= 3 && cut <= unpadded.size(); ++cut) {
+                CHECK(same_decode(unpadded.substr(0, unpadded.size() - cut), level));
+            }
+        }
+    }
+
+    // Некорректный символ в каждой позиции: разбор останавливается там же, где и прежде
+    const char invalid[] = {'=', ' ', '\n', '-', '_', '.', '\0', '\x7F', '\x80', '\xFF', '@', '['};
+    for (size_t size : {0, 1, 2, 3, 47, 48, 49, 96, 97, 130}) {
+        const std::string text = legacy_encode(random_bytes(size, rng));
+        for (size_t pos = 0; pos <= text.size(); ++pos) {
+            for (char c : invalid) {
+                std::string damaged = text;
+                damaged.insert(damaged.begin() + static_cast<std::ptrdiff_t>(pos), c);
+                for (SimdLevel level : all) CHECK(same_decode(damaged, level));
+
+                if (pos < text.size()) {
+                    std::string replaced = text;
+                    replaced[pos] = c;
+                    for (SimdLevel level : all) CHECK(same_decode(replaced, level));
+                }
+            }
+        }
+    }
+
+    // Случайный мусор и строки из одних символов алфавита произвольной длины
+    for (int round = 0; round < 2000; ++round) {
+        const std::string garbage = random_bytes(rng() % 200, rng);
+        std::string alphabet_only(rng() % 200, 'A');
+        for (auto& c : alphabet_only) c = legacy::base64_chars[rng() % 64];
+        for (SimdLevel level : all) {
+            CHECK(same_decode(garbage, level));
+            CHECK(same_decode(alphabet_only, level));
+        }
+    }
+
+    // Публичные функции используют лучший доступный путь
+    {
+        const std::string data = random_bytes(100000, rng);
+        CHECK(utils::base64_encode(data) == legacy_encode(data));
+        CHECK(utils::base64_decode(utils::base64_encode(data)) == data);
+    }
+
+    return test::result("test_base64");
+}
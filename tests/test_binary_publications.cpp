@@ -0,0 +1,58 @@
+// Проверка двоичных публикаций от начала до конца: клиент предлагает формат "binary" при connect,
+// StandInServer рассылает двоичные SendValues с общим словарём тегов. Первые публикации с именами
+// тегов клиент теряет (он ещё не подписан - libzmq отбрасывает их по кадру топика), поэтому
+// теги должны появиться из повтора имён не позднее чем через интервал повтора словаря.
+
+#include "client_access.h"
+#include "test_util.h"
+
+int main() {
+    StandInServer::Options options;
+    options.binary = true;
+    StandInServer server(options);
+    TestClient client("test_client", "127.0.0.1");
+    TestClientAccess access{client};
+
+    client.start();
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!access.connected() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    CHECK(access.connected());
+
+    // Публикации с определениями имён уходят мимо клиента
+    server.publish(10);
+    while (server.published() < 10 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    access.subscribe("default");
+    uint64_t first_received = 0;
+    Tag tag;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (access.tags().get(StandInServer::tag_name(0), tag)) {
+            first_received = tag.value;
+            break;
+        }
+        server.publish(1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    CHECK(first_received > 10);
+    CHECK(first_received <= 10 + 2 * TagDictionary::DEFAULT_RESEND_INTERVAL);  // Запас на подключение SUB
+    std::printf("tags known from publication %llu\n", static_cast<unsigned long long>(first_received));
+
+    // Дальше все теги каждой публикации приходят по id
+    server.publish(5);
+    const uint64_t last = first_received + 5;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (access.tags().get(StandInServer::tag_name(15), tag) && tag.value >= last) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    for (size_t i = 0; i < options.tags_per_publication; ++i) {
+        CHECK(access.tags().get(StandInServer::tag_name(i), tag) && tag.value == server.published());
+    }
+    CHECK(server.binary_published() == server.published());
+
+    client.stop();
+    return test::result("test_binary_publications");
+}
@@ -0,0 +1,160 @@
+// Lz4BlockCodec: обратимость сжатия на данных разной природы и длины, граничные длины
+// литералов и совпадений, отказ на повреждённых данных. При сборке с liblz4
+// (ZMQ_CLIENT_HAVE_LZ4) - совместимость формата в обе стороны с LZ4_decompress_safe/LZ4_compress_default.
+
+#include "codec.h"
+#include "test_util.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef ZMQ_CLIENT_HAVE_LZ4
+#include <lz4.h>
+#endif
+
+namespace
+{
+    using Bytes = std::vector<uint8_t>;
+
+    Bytes random_bytes(size_t size, uint64_t seed) {
+        std::mt19937_64 rng(seed);
+        Bytes data(size);
+        for (auto& b : data) b = static_cast<uint8_t>(rng());
+        return data;
+    }
+
+    // Похоже на исходный текст программы: повторяющиеся слова с вариациями
+    Bytes text_bytes(size_t size, uint64_t seed) {
+        static const char* words[] = {"VAR ", "END_VAR\n", "IF ", "THEN\n", "x := x + 1;\n", "MW", "IX0.",
+                                      "FUNCTION_BLOCK ", "(* comment *)\n", "TON(IN := ", "PT := T#100ms);\n"};
+        std::mt19937_64 rng(seed);
+        Bytes data;
+        data.reserve(size);
+        while (data.size() < size) {
+            std::string word = words[rng() % (sizeof(words) / sizeof(words[0]))];
+            if (rng() % 4 == 0) word += std::to_string(rng() % 1000);
+            data.insert(data.end(), word.begin(), word.end());
+        }
+        data.resize(size);
+        return data;
+    }
+
+    Bytes compress(const Codec& codec, const Bytes& data) {
+        Bytes packed(codec.max_compressed_size(data.size()));
+        packed.resize(codec.compress(data.data(), data.size(), packed.data(), packed.size()));
+        return packed;
+    }
+
+    bool round_trip(const Codec& codec, const Bytes& data) {
+        const Bytes packed = compress(codec, data);
+        if (packed.empty()) return false;
+        Bytes restored(data.size() + 16);
+        restored.resize(codec.decompress(packed.data(), packed.size(), restored.data(), restored.size()));
+        bool ok = restored == data;
+#ifdef ZMQ_CLIENT_HAVE_LZ4
+        // Наш формат распаковывает штатная библиотека...
+        Bytes reference(data.size() + 16);
+        const int n = LZ4_decompress_safe(reinterpret_cast<const char*>(packed.data()),
+                                          reinterpret_cast<char*>(reference.data()),
+                                          static_cast<int>(packed.size()), static_cast<int>(reference.size()));
+        ok = ok && n == static_cast<int>(data.size()) && std::equal(data.begin(), data.end(), reference.begin());
+
+        // ...а мы - её выход
+        Bytes theirs(static_cast<size_t>(LZ4_compressBound(static_cast<int>(data.size()))));
+        theirs.resize(static_cast<size_t>(LZ4_compress_default(reinterpret_cast<const char*>(data.data()),
+                                                               reinterpret_cast<char*>(theirs.data()),
+                                                               static_cast<int>(data.size()),
+                                                               static_cast<int>(theirs.size()))));
+        Bytes ours(data.size() + 16);
+        ours.resize(codec.decompress(theirs.data(), theirs.size(), ours.data(), ours.size()));
+        ok = ok && ours == data;
+#endif
+        return ok;
+    }
+}
+
+int main() {
+    const Lz4BlockCodec codec;
+
+    // Пустой вход и короткие блоки вокруг MF_LIMIT (совпадения в них не ищутся)
+    for (size_t size = 0; size <= 40; ++size) {
+        CHECK(round_trip(codec, Bytes(size, 'a')));
+        CHECK(round_trip(codec, random_bytes(size, size)));
+    }
+    CHECK(round_trip(codec, Bytes{}));
+
+    // Длины литералов и совпадений около границ кодирования (15, 15 + 255, ...)
+    for (size_t length : {14, 15, 16, 18, 19, 20, 269, 270, 271, 272, 273, 274, 525, 1000}) {
+        Bytes literals = random_bytes(length, 7 + length);
+        Bytes data = literals;
+        data.insert(data.end(), 64, 'z');
+        CHECK(round_trip(codec, data));
+
+        Bytes matches(8, 'q');
+        matches.resize(8 + length, 'q');
+        auto tail = random_bytes(16, length);
+        matches.insert(matches.end(), tail.begin(), tail.end());
+        CHECK(round_trip(codec, matches));
+    }
+
+    // Данные разной природы, включая совпадения дальше MAX_OFFSET
+    for (size_t size : {1000, 63 * 1024, 200 * 1024}) {
+        CHECK(round_trip(codec, random_bytes(size, size)));
+        CHECK(round_trip(codec, text_bytes(size, size)));
+        CHECK(round_trip(codec, Bytes(size, 0)));
+        Bytes periodic = random_bytes(70000, 3);
+        periodic.resize(size + 70000);
+        for (size_t i = 70000; i < periodic.size(); ++i) periodic[i] = periodic[i - 70000];
+        CHECK(round_trip(codec, periodic));
+    }
+
+    // Степень сжатия: текст сжимается, несжимаемые данные растут не больше оценки
+    {
+        const Bytes text = text_bytes(63 * 1024, 11);
+        CHECK(compress(codec, text).size() < text.size() / 2);
+        const Bytes noise = random_bytes(63 * 1024, 12);
+        CHECK(compress(codec, noise).size() <= codec.max_compressed_size(noise.size()));
+    }
+
+    // Недостаточный буфер сжатия
+    {
+        const Bytes data = text_bytes(1000, 1);
+        Bytes small(codec.max_compressed_size(data.size()) - 1);
+        CHECK(codec.compress(data.data(), data.size(), small.data(), small.size()) == 0);
+    }
+
+    // Повреждённые и усечённые данные: отказ без выхода за границы буфера
+    {
+        const Bytes data = text_bytes(4096, 5);
+        const Bytes packed = compress(codec, data);
+        Bytes out(data.size());
+        for (size_t n = 0; n < packed.size(); ++n) {
+            const size_t result = codec.decompress(packed.data(), n, out.data(), out.size());
+            CHECK(result <= out.size());
+            CHECK(result != data.size() || n == packed.size());
+        }
+        // Ёмкость меньше исходного размера
+        CHECK(codec.decompress(packed.data(), packed.size(), out.data(), out.size() - 1) == 0);
+
+        std::mt19937_64 rng(9);
+        for (int i = 0; i < 1000; ++i) {
+            Bytes damaged = packed;
+            damaged[rng() % damaged.size()] ^= static_cast<uint8_t>(1u << (rng() % 8));
+            CHECK(codec.decompress(damaged.data(), damaged.size(), out.data(), out.size()) <= out.size());
+        }
+    }
+
+    // Реестр кодеков
+    {
+        CodecRegistry registry;
+        CHECK(registry.find("lz4") != nullptr);
+        CHECK(registry.find("zstd") == nullptr);
+        CHECK(registry.names() == std::vector<std::string>{"lz4"});
+    }
+
+#ifdef ZMQ_CLIENT_HAVE_LZ4
+    std::printf("liblz4 %s: format compatibility checked\n", LZ4_versionString());
+#endif
+    return test::result("test_codec");
+}
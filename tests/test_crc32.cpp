@@ -0,0 +1,66 @@
+// CRC32: calculate_crc32 (PCLMULQDQ при поддержке процессором, иначе slice-by-16) и
+// инкрементальный Crc32 совпадают с побайтовым расчётом по таблице - для невыровненных адресов,
+// длин до и после порога векторного пути (64 байта) и хвостов, не кратных 16.
+
+#include "crc_utils.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+    uint32_t reference(const uint8_t* data, size_t len, uint32_t crc = 0) {
+        return ~utils::detail::crc32_bytewise(~crc, data, len);
+    }
+} // namespace
+
+int main() {
+    std::mt19937_64 rng(7);
+    std::vector<uint8_t> data(64 * 1024 + 64);
+    for (auto& b : data) b = static_cast<uint8_t>(rng());
+
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    CHECK(utils::calculate_crc32(check, sizeof(check)) == 0xCBF43926u);
+
+    // Все длины до 1 КБ и несколько крупных - со сдвигом начала на 0..15 байт
+    std::vector<size_t> lengths;
+    for (size_t len = 0; len <= 1024; ++len) lengths.push_back(len);
+    for (size_t len : {4095, 4096, 4097, 65535, 65536}) lengths.push_back(len);
+    for (size_t offset = 0; offset < 16; ++offset) {
+        for (size_t len : lengths) {
+            const uint8_t* p = data.data() + offset;
+            CHECK(utils::calculate_crc32(p, len) == reference(p, len));
+        }
+    }
+
+    // Продолжение расчёта с ненулевого crc и части произвольной длины
+    for (size_t split : {1, 15, 63, 64, 65, 200, 1000, 4096}) {
+        const size_t len = 10000;
+        const uint32_t head = utils::calculate_crc32(data.data(), split);
+        CHECK(utils::calculate_crc32(data.data() + split, len - split, head) == reference(data.data(), len));
+
+        utils::Crc32 crc;
+        for (size_t pos = 0; pos < len; pos += split) {
+            crc.update(data.data() + pos, std::min(split, len - pos));
+        }
+        CHECK(crc.value() == reference(data.data(), len));
+    }
+
+#ifdef UTILS_CRC32_PCLMUL
+    // Векторная свёртка напрямую: длины, кратные 16, начиная с 64
+    if (utils::detail::has_pclmul()) {
+        for (size_t offset = 0; offset < 16; ++offset) {
+            for (size_t len = 64; len <= 4096 + 64; len += 16) {
+                const uint8_t* p = data.data() + offset;
+                const uint32_t seed = static_cast<uint32_t>(rng());
+                CHECK(utils::detail::crc32_pclmul(seed, p, len) == utils::detail::crc32_bytewise(seed, p, len));
+            }
+        }
+    } else {
+        std::printf("PCLMULQDQ is not supported: vector path skipped\n");
+    }
+#endif
+    return test::result("test_crc32");
+}
@@ -0,0 +1,52 @@
+// Проверка контроля соединения под полной нагрузкой публикациями: StandInServer непрерывно
+// рассылает публикации, а heartbeat отправляется каждые 100 мс в течение 5 секунд (при масштабе 1).
+// Ни один heartbeat не должен завершиться неудачей или ответом дольше 500 мс (таймаут - 1 с),
+// соединение не должно считаться разорванным, а публикации - переставать приниматься.
+
+#include "client_access.h"
+#include "test_util.h"
+
+#include <algorithm>
+
+int main(int argc, char** argv) {
+    using namespace std::chrono;
+    const auto load_time = duration_cast<milliseconds>(duration<double>(5.0 * test::scale(argc, argv)));
+
+    StandInServer server;
+    TestClient client("test_client", "127.0.0.1");
+    TestClientAccess access{client};
+    CHECK(start_client(client, server));
+
+    server.flood(true);
+    size_t heartbeats = 0, failures = 0, disconnects = 0;
+    double worst_ms = 0;
+    uint64_t first_value = 0, last_value = 0;
+    Tag tag;
+    if (access.tags().get(StandInServer::tag_name(0), tag)) first_value = tag.value;
+
+    const auto end = steady_clock::now() + load_time;
+    while (steady_clock::now() < end) {
+        bool ok = false;
+        const double sec = test::seconds([&] { ok = access.heartbeat(); });
+        ++heartbeats;
+        if (!ok) ++failures;
+        if (!access.connected()) ++disconnects;
+        worst_ms = std::max(worst_ms, sec * 1000.0);
+        std::this_thread::sleep_for(milliseconds(100));
+    }
+    server.flood(false);
+    if (access.tags().get(StandInServer::tag_name(0), tag)) last_value = tag.value;
+
+    std::printf("heartbeats %zu, failed %zu, worst %.1f ms; publications sent %llu, applied %llu\n",
+                heartbeats, failures, worst_ms,
+                static_cast<unsigned long long>(server.published()),
+                static_cast<unsigned long long>(last_value - first_value));
+    CHECK(heartbeats > 0);
+    CHECK(failures == 0);
+    CHECK(disconnects == 0);
+    CHECK(worst_ms < 500.0);
+    CHECK(last_value > first_value);   // Нагрузка действительно принималась
+
+    client.stop();
+    return test::result("test_liveness_under_load");
+}
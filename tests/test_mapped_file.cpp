@@ -0,0 +1,40 @@
+// MappedFile: укорачивание отображённого файла обнаруживается truncated(), а расчёт CRC32
+// такого файла завершается исключением вместо SIGBUS при обращении к странице за концом файла.
+
+#include "crc_utils.h"
+#include "test_util.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+int main() {
+    const auto path = std::filesystem::temp_directory_path() / "zmq_client_test_mapped_file.bin";
+    const std::string data(256 * 1024, 'x');
+    std::ofstream(path, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+
+    {
+        const utils::MappedFile file(path);
+        CHECK(file.size() == data.size());
+        CHECK(!file.truncated());
+        CHECK(utils::calculate_file_crc32(file) == utils::calculate_crc32(data.data(), data.size()));
+
+        // Дописывание в конец отображению не мешает
+        std::ofstream(path, std::ios::binary | std::ios::app) << "tail";
+        CHECK(!file.truncated());
+
+#ifndef _WIN32  // В Windows укоротить отображённый файл система не даёт
+        std::filesystem::resize_file(path, 1024);
+        CHECK(file.truncated());
+        bool thrown = false;
+        try {
+            (void)utils::calculate_file_crc32(file);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        CHECK(thrown);
+#endif
+    }
+    std::filesystem::remove(path);
+    return test::result("test_mapped_file");
+}
@@ -0,0 +1,76 @@
+// Проверка: в установившемся режиме создание запроса, доставка ответа и ожидание
+// не выделяют память. Глобальные operator new/delete заменены счётчиком.
+
+#include "request_manager.h"
+#include "test_util.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<size_t> allocations{0};
+}
+
+namespace
+{
+    void* counted_malloc(std::size_t size) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        if (void* p = std::malloc(size ? size : 1)) return p;
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(std::size_t size) { return counted_malloc(size); }
+void* operator new[](std::size_t size) { return counted_malloc(size); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+int main() {
+    RequestManager manager;
+    const std::string key = "client-1";
+    const std::string request = "read_tag";
+    Response response = Response::success(key, request, "Tag value: 42");
+    Response out;
+    size_t completed = 0;
+
+    // Один цикл синхронного запроса и один - асинхронного с обработчиком
+    auto cycle = [&] {
+        {
+            auto req = manager.create(key, request);
+            response.id = req->id();
+            CHECK(manager.process_response(response));
+            CHECK(req->wait(out, std::chrono::milliseconds(0)));
+        }
+        {
+            // Захват одного указателя помещается во внутренний буфер std::function
+            auto req = manager.create_async(key, request,
+                                            [counter = &completed](bool ok, const Response&) {
+                                                if (ok) ++*counter;
+                                            },
+                                            std::chrono::milliseconds(0));
+            response.id = req->id();
+            CHECK(manager.process_response(response));
+        }
+        manager.expire();   // Снимает сроки уже завершённых запросов
+    };
+
+    // Прогрев: пул, строки ответов и очередь сроков достигают рабочей ёмкости
+    for (int i = 0; i < 2000; ++i) cycle();
+
+    const size_t before = allocations.load();
+    CHECK(before > 0);      // Счётчик действительно подключён (пул и строки выделялись при прогреве)
+    constexpr int STEADY_CYCLES = 100000;
+    for (int i = 0; i < STEADY_CYCLES; ++i) cycle();
+    const size_t steady = allocations.load() - before;
+
+    std::printf("allocations in %d steady-state cycles: %zu\n", STEADY_CYCLES, steady);
+    CHECK(steady == 0);
+    CHECK(completed == 2000 + STEADY_CYCLES);
+    CHECK(out.message == "Tag value: 42");
+    return test::result("test_request_allocations");
+}
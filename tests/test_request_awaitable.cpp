@@ -0,0 +1,97 @@
+// RequestAwaitable: сопрограмма возобновляется при любом исходе запуска запроса -
+// ответ до и после приостановки, таймаут, отказ до регистрации обработчика и исключение.
+
+#include "request_awaitable.h"
+#include "request_manager.h"
+#include "test_util.h"
+
+#include <optional>
+#include <stdexcept>
+
+namespace
+{
+    // Сопрограмма без планировщика: выполняется сразу, результат сохраняется во внешней переменной
+    struct Task {
+        struct promise_type {
+            Task get_return_object() { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    struct Outcome {
+        bool finished = false;
+        bool threw = false;
+        Response response{};
+    };
+
+    Task await(RequestAwaitable::Starter start, Outcome& out) {
+        try {
+            out.response = co_await RequestAwaitable("client-1", "read_tag", std::move(start));
+        } catch (const std::exception&) {
+            out.threw = true;
+        }
+        out.finished = true;
+    }
+}
+
+int main() {
+    RequestManager manager;
+
+    // Ответ приходит после приостановки
+    {
+        Outcome out;
+        RequestHandle pending;
+        await([&](SyncRequest::Callback cb) {
+            pending = manager.create_async("client-1", "read_tag", std::move(cb), std::chrono::seconds(5));
+            return pending;
+        }, out);
+        CHECK(!out.finished);
+        Response response = Response::success("client-1", "read_tag");
+        response.id = pending->id();
+        CHECK(manager.process_response(response));
+        CHECK(out.finished && !out.threw && out.response.isSuccess());
+    }
+
+    // Ответ приходит ещё до возврата из Starter: сопрограмма не приостанавливается
+    {
+        Outcome out;
+        await([&](SyncRequest::Callback cb) {
+            auto request = manager.create_async("client-1", "read_tag", std::move(cb), std::chrono::seconds(5));
+            Response response = Response::success("client-1", "read_tag");
+            response.id = request->id();
+            manager.process_response(response);
+            return request;
+        }, out);
+        CHECK(out.finished && out.response.isSuccess());
+    }
+
+    // Таймаут
+    {
+        Outcome out;
+        await([&](SyncRequest::Callback cb) {
+            return manager.create_async("client-1", "read_tag", std::move(cb), std::chrono::milliseconds(0));
+        }, out);
+        CHECK(!out.finished);
+        manager.expire();
+        CHECK(out.finished && !out.threw && !out.response.isSuccess());
+    }
+
+    // Запрос не зарегистрирован (например, отказ create_async): обработчик не вызывается
+    {
+        Outcome out;
+        await([](SyncRequest::Callback) { return RequestHandle{}; }, out);
+        CHECK(out.finished && !out.threw && !out.response.isSuccess());
+    }
+
+    // Исключение при запуске передаётся в сопрограмму
+    {
+        Outcome out;
+        await([](SyncRequest::Callback) -> RequestHandle { throw std::runtime_error("send failed"); }, out);
+        CHECK(out.finished && out.threw);
+    }
+
+    return test::result("test_request_awaitable");
+}
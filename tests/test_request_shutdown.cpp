@@ -0,0 +1,34 @@
+// Проверка: запросы, ожидающие ответа при уничтожении RequestManager, завершаются неудачей
+// (обработчики вызываются), а их объекты возвращаются в ещё не уничтоженный пул.
+
+#include "request_manager.h"
+#include "test_util.h"
+
+int main() {
+    size_t failed = 0, succeeded = 0;
+    RequestHandle kept;
+    {
+        RequestManager manager;
+        for (int i = 0; i < 8; ++i) {
+            manager.create_async("client-1", "read_tag",
+                                 [&](bool ok, const Response&) { ++(ok ? succeeded : failed); },
+                                 std::chrono::seconds(60));
+        }
+        kept = manager.create("client-1", "read_tag");
+
+        // cancel_all() снимает и сроки: expire() после него ничего не завершает повторно
+        manager.cancel_all();
+        CHECK(failed == 8);
+        CHECK(kept->ready());
+        manager.expire(std::chrono::steady_clock::now() + std::chrono::hours(1));
+        CHECK(failed == 8);
+
+        manager.create_async("client-1", "read_tag",
+                             [&](bool ok, const Response&) { ++(ok ? succeeded : failed); },
+                             std::chrono::seconds(60));
+        kept = RequestHandle{};     // Последняя ссылка - до уничтожения пула
+    }
+    CHECK(failed == 9);
+    CHECK(succeeded == 0);
+    return test::result("test_request_shutdown");
+}
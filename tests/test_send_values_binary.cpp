@@ -0,0 +1,157 @@
+// Двоичный формат SendValues: обратимость кодирования, словарь тегов между кадрами,
+// совпадение с JSON-форматом, отказ на повреждённых кадрах и кадр топика.
+
+#include "dto.h"
+#include "test_util.h"
+
+#include <random>
+#include <stdexcept>
+
+namespace
+{
+    std::vector<Tag> make_tags(size_t count, uint64_t seed) {
+        std::mt19937_64 rng(seed);
+        std::vector<Tag> tags(count);
+        for (size_t i = 0; i < count; ++i) {
+            tags[i].key = "%ID" + std::to_string(i);
+            tags[i].value = rng();
+            tags[i].quality = fromInt(static_cast<int>(rng() % 3));
+            // Формат хранит миллисекунды: берём время без дробной части
+            tags[i].timestamp = sysclk::time_point(std::chrono::milliseconds(rng() % 4000000000000ULL));
+        }
+        return tags;
+    }
+
+    bool same_tags(const std::vector<Tag>& a, const std::vector<Tag>& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].key != b[i].key || a[i].value != b[i].value ||
+                a[i].quality != b[i].quality || a[i].timestamp != b[i].timestamp) return false;
+        }
+        return true;
+    }
+
+    template <typename F>
+    bool throws(F&& f) {
+        try { f(); } catch (const std::exception&) { return true; }
+        return false;
+    }
+}
+
+int main() {
+    TagDictionary sender, receiver;
+
+    // Первый кадр несёт имена, последующие - только id
+    for (int round = 0; round < 3; ++round) {
+        SendValues message{"client-1", "default", make_tags(1000, 42 + round)};
+        const std::string frame = message.toBinary(sender);
+        CHECK(SendValues::isBinary(frame.data(), frame.size()));
+        if (round > 0) CHECK(frame.find("%ID999") == std::string::npos);
+
+        auto decoded = SendValues::fromBinary(frame.data(), frame.size(), receiver);
+        CHECK(decoded.key == "client-1");
+        CHECK(decoded.topic == "default");
+        CHECK(same_tags(decoded.values, message.values));
+
+        // Тот же результат, что и через JSON
+        auto from_json = SendValues::fromJSON(message.toJSON());
+        CHECK(same_tags(decoded.values, from_json.values));
+    }
+
+    // Новые теги в середине потока получают имена в том же кадре
+    {
+        auto tags = make_tags(1005, 7);
+        SendValues message{"client-1", "default", tags};
+        const std::string frame = message.toBinary(sender);
+        auto decoded = SendValues::fromBinary(frame.data(), frame.size(), receiver);
+        CHECK(same_tags(decoded.values, tags));
+    }
+
+    // Получатель без словаря (кадр с определениями потерян) пропускает неизвестные id
+    {
+        TagDictionary fresh;
+        SendValues message{"client-1", "default", make_tags(10, 1)};
+        const std::string frame = message.toBinary(sender);
+        auto decoded = SendValues::fromBinary(frame.data(), frame.size(), fresh);
+        CHECK(decoded.values.empty());
+    }
+
+    // Имена повторяются раз в resend_interval кадров: получатель, потерявший определения или
+    // подключившийся позже, восстанавливает словарь не позднее чем через interval кадров
+    {
+        TagDictionary publisher(4), late;
+        SendValues message{"client-1", "default", make_tags(10, 1)};
+        size_t frames_until_known = 0;
+        for (size_t i = 1; i <= 8 && frames_until_known == 0; ++i) {
+            const std::string frame = message.toBinary(publisher);
+            if (i > 1) {    // Первый кадр с определениями потерян
+                auto decoded = SendValues::fromBinary(frame.data(), frame.size(), late);
+                if (same_tags(decoded.values, message.values)) frames_until_known = i;
+            }
+        }
+        CHECK(frames_until_known == 5);   // Повтор через 4 кадра после первого
+    }
+
+    // Интервал 1 - имена в каждом кадре
+    {
+        TagDictionary every_frame(1);
+        SendValues message{"client-1", "default", make_tags(3, 1)};
+        for (int i = 0; i < 3; ++i) {
+            TagDictionary fresh;
+            const std::string frame = message.toBinary(every_frame);
+            CHECK(same_tags(SendValues::fromBinary(frame.data(), frame.size(), fresh).values, message.values));
+        }
+    }
+
+    // Пустое сообщение
+    {
+        TagDictionary d1, d2;
+        SendValues message{"k", "", {}};
+        const std::string frame = message.toBinary(d1);
+        auto decoded = SendValues::fromBinary(frame.data(), frame.size(), d2);
+        CHECK(decoded.key == "k" && decoded.topic.empty() && decoded.values.empty());
+    }
+
+    // JSON не принимается за двоичный кадр
+    {
+        const std::string text = SendValues{"k", "t", make_tags(2, 3)}.toJSON();
+        CHECK(!SendValues::isBinary(text.data(), text.size()));
+    }
+
+    // Повреждённые кадры: любое усечение и неверные заголовки отвергаются исключением
+    {
+        TagDictionary d1;
+        const std::string frame = SendValues{"client-1", "default", make_tags(20, 5)}.toBinary(d1);
+        for (size_t n = 0; n < frame.size(); ++n) {
+            TagDictionary d2;
+            CHECK(throws([&] { SendValues::fromBinary(frame.data(), n, d2); }));
+        }
+
+        std::string bad_magic = frame;
+        bad_magic[1] = 'X';
+        TagDictionary d3;
+        CHECK(throws([&] { SendValues::fromBinary(bad_magic.data(), bad_magic.size(), d3); }));
+
+        std::string bad_version = frame;
+        bad_version[3] = static_cast<char>(SendValues::BINARY_VERSION + 1);
+        CHECK(throws([&] { SendValues::fromBinary(bad_version.data(), bad_version.size(), d3); }));
+
+        // Огромное число тегов в заголовке при коротком кадре не должно приводить к выделению памяти под него
+        std::string huge_count(frame.data(), 4);
+        wire::put_str(huge_count, "client-1");
+        wire::put_str(huge_count, "default");
+        wire::put_u32(huge_count, 0xFFFFFFFFu);
+        CHECK(throws([&] { SendValues::fromBinary(huge_count.data(), huge_count.size(), d3); }));
+    }
+
+    // Кадр топика - префикс подписки ZMQ: топик не должен совпадать с началом другого топика
+    {
+        const std::string sub = SendValues::topicFrame("client-1", "default");
+        const std::string other = SendValues::topicFrame("client-1", "default_topic");
+        CHECK(other.compare(0, sub.size(), sub) != 0);
+        CHECK(SendValues::topicFrame("client-1", "default").compare(0, sub.size(), sub) == 0);
+        CHECK(SendValues::topicFrame("client-10", "default").compare(0, sub.size(), sub) != 0);
+    }
+
+    return test::result("test_send_values_binary");
+}
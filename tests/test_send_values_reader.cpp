@@ -0,0 +1,114 @@
+// Потоковый разбор JSON-публикаций SendValuesReader: порядок полей, чужой ключ,
+// вложенные массивы, неполные теги и усечённые сообщения.
+
+#include "send_values_reader.h"
+#include "test_util.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Applied {
+        std::string key;
+        uint64_t    value;
+        Quality     quality;
+        int64_t     timestamp_ms;
+    };
+
+    struct Result {
+        long                 rc;
+        std::vector<Applied> tags;
+    };
+
+    Result read(SendValuesReader& reader, const std::string& text) {
+        Result result{0, {}};
+        result.rc = reader.read(text.data(), text.size(),
+                                [&](const std::string& key, uint64_t value, Quality quality, sysclk::time_point ts) {
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(ts.time_since_epoch()).count();
+            result.tags.push_back({key, value, quality, static_cast<int64_t>(ms)});
+        });
+        return result;
+    }
+
+    const std::string TAGS = R"([{"key":"%ID1","value":10,"quality":0,"timestamp":1000},)"
+                             R"({"timestamp":2000,"quality":1,"value":18446744073709551615,"key":"%ID2"}])";
+}
+
+int main() {
+    SendValuesReader reader("client-1");
+
+    // Ключ клиента до и после "values", поля тегов в любом порядке
+    for (const std::string& text : {
+            R"({"key":"client-1","topic":"default","values":)" + TAGS + "}",
+            R"({"topic":"default","values":)" + TAGS + R"(,"key":"client-1"})"}) {
+        Result r = read(reader, text);
+        CHECK(r.rc == 2);
+        CHECK(r.tags.size() == 2);
+        if (r.tags.size() != 2) continue;
+        CHECK(r.tags[0].key == "%ID1" && r.tags[0].value == 10);
+        CHECK(r.tags[0].quality == Quality::GOOD && r.tags[0].timestamp_ms == 1000);
+        CHECK(r.tags[1].key == "%ID2" && r.tags[1].value == UINT64_MAX);
+        CHECK(r.tags[1].quality == Quality::BAD && r.tags[1].timestamp_ms == 2000);
+    }
+
+    // Совпадает с разбором через DOM
+    {
+        const std::string text = SendValues{"client-1", "default", SendValues::fromJSON(
+                R"({"key":"client-1","topic":"default","values":)" + TAGS + "}").values}.toJSON();
+        Result r = read(reader, text);
+        CHECK(r.rc == 2 && r.tags.size() == 2);
+    }
+
+    // Чужой ключ - до и после "values": ничего не применяется
+    CHECK(read(reader, R"({"key":"client-2","values":)" + TAGS + "}").tags.empty());
+    {
+        Result r = read(reader, R"({"values":)" + TAGS + R"(,"key":"client-2"})");
+        CHECK(r.rc == 0 && r.tags.empty());
+    }
+
+    // Без ключа клиента публикация не применяется
+    {
+        Result r = read(reader, R"({"values":)" + TAGS + "}");
+        CHECK(r.rc == 0 && r.tags.empty());
+    }
+
+    // Вложенные массивы внутри тегов и в корне не завершают массив "values"
+    {
+        Result r = read(reader, R"({"key":"client-1","values":[)"
+                                R"({"key":"%ID1","extra":[1,[2,3],{"key":"x","value":5}],"value":1,"quality":0,"timestamp":1},)"
+                                R"({"key":"%ID2","value":2,"quality":0,"timestamp":2}],"other":[[{"key":"%ID3"}]]})");
+        CHECK(r.rc == 2);
+        CHECK(r.tags.size() == 2);
+        if (r.tags.size() == 2) {
+            CHECK(r.tags[0].key == "%ID1" && r.tags[0].value == 1);
+            CHECK(r.tags[1].key == "%ID2" && r.tags[1].value == 2);
+        }
+    }
+
+    // Тег без любого из обязательных полей делает сообщение некорректным
+    for (const char* tag : {R"({"value":1,"quality":0,"timestamp":1})",
+                            R"({"key":"%ID1","quality":0,"timestamp":1})",
+                            R"({"key":"%ID1","value":1,"timestamp":1})",
+                            R"({"key":"%ID1","value":1,"quality":0})"}) {
+        Result r = read(reader, std::string(R"({"key":"client-1","values":[{"key":"%ID0","value":0,"quality":0,"timestamp":0},)") + tag + "]}");
+        CHECK(r.rc == -1);
+        CHECK(r.tags.empty());
+        CHECK(!reader.error().empty());
+    }
+
+    // Усечённое сообщение (на любом байте) не применяется даже частично
+    {
+        const std::string text = R"({"key":"client-1","values":)" + TAGS + "}";
+        for (size_t n = 0; n < text.size(); ++n) {
+            Result r = read(reader, text.substr(0, n));
+            CHECK(r.rc == -1);
+            CHECK(r.tags.empty());
+        }
+    }
+
+    // Повторное использование после ошибки
+    CHECK(read(reader, R"({"key":"client-1","values":)" + TAGS + "}").rc == 2);
+
+    return test::result("test_send_values_reader");
+}
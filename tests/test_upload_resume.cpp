@@ -0,0 +1,52 @@
+// Проверка продолжения передачи файла после обрыва связи: StandInServer обрывает соединение,
+// получив 40% файла (8 МБ случайных данных при масштабе 1), и отвечает на file_status
+// подтверждённым смещением. Передача должна продолжиться с этого смещения, а не с начала,
+// собранный сервером файл - совпасть с исходным, а CRC32 клиента - с CRC32 файла.
+
+#include "client_access.h"
+#include "test_util.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+int main(int argc, char** argv) {
+    const auto size = std::max<size_t>(static_cast<size_t>(8 * 1024 * 1024 * test::scale(argc, argv)),
+                                       16 * TestClientAccess::FILE_CHUNK_SIZE);
+    const auto path = std::filesystem::temp_directory_path() / "zmq_client_test_upload_resume.bin";
+    std::string data(size, '\0');
+    {
+        std::mt19937_64 rng(3);
+        for (auto& c : data) c = static_cast<char>(rng());
+        std::ofstream(path, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    StandInServer::Options options;
+    options.latency = std::chrono::milliseconds(1);
+    options.drop_after_bytes = size * 2 / 5;
+    StandInServer server(options);
+    TestClient client("test_client", "127.0.0.1");
+    TestClientAccess access{client};
+    CHECK(start_client(client, server));
+
+    const uint32_t crc = access.send_file(path.string(), 8);
+    CHECK(server.drops() == 1);
+    CHECK(crc == utils::calculate_crc32(data.data(), data.size()));
+    CHECK(server.file(path.filename().string()) == data);
+
+    // Продолжение с подтверждённого места: сервер назвал ненулевое смещение, и первый
+    // чанк после file_status пришёл именно с него
+    const auto status = server.status_offsets();
+    const auto resumed = server.resumed_offsets();
+    CHECK(!status.empty() && status.front() > 0);
+    CHECK(!resumed.empty() && !status.empty() && resumed.front() == status.front());
+    // Повторно переданы только чанки окна, потерянные при обрыве, и отклонённые сервером
+    // за разрывом (они ждали в очереди клиента и пришли после переподключения)
+    std::printf("chunk bytes: %llu for %zu byte file\n",
+                static_cast<unsigned long long>(server.chunk_bytes()), size);
+    CHECK(server.chunk_bytes() <= size + 2 * 8 * TestClientAccess::FILE_CHUNK_SIZE);
+
+    client.stop();
+    std::filesystem::remove(path);
+    return test::result("test_upload_resume");
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// Минимальные средства проверки для тестов и замеров без внешнего тестового фреймворка.
+// CHECK не прерывает тест: сообщает место ошибки и учитывается в итоговом коде возврата.
+namespace test
+{
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline int result(const char* name) {
+        if (failures() == 0) {
+            std::printf("%s: OK\n", name);
+            return EXIT_SUCCESS;
+        }
+        std::fprintf(stderr, "%s: %d check(s) failed\n", name, failures());
+        return EXIT_FAILURE;
+    }
+
+    // Время выполнения f в секундах
+    template <typename F>
+    double seconds(F&& f) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Масштаб нагрузки замеров: аргумент командной строки (ctest запускает с малым значением)
+    inline double scale(int argc, char** argv, double fallback = 1.0) {
+        return argc > 1 ? std::atof(argv[1]) : fallback;
+    }
+} // namespace test
+
+#define CHECK(cond)                                                                     \
+    do {                                                                                \
+        if (!(cond)) {                                                                  \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++test::failures();                                                         \
+        }                                                                               \
+    } while (0)